@@ -82,7 +82,8 @@ basin.prepare_run <- function(basin_object,
   basin_list[["G_GLOWET"]] <- basin_object@G_GLOWET
   basin_list[["G_RESAREA"]] <- basin_object@G_RESAREA
   basin_list[["G_LAKAREA"]] <- basin_object@G_LAKAREA
-  basin_list[["routeOrder"]] <- basin_object@routeOrder
+  # routeOrder is not passed anymore: routing levels are derived from "outflow" in C++
+  # (add basin_object@routeOrder as "routeOrder" to use the old routing order based on flow accumulation)
   basin_list[["GAREA"]] <- basin_object@GAREA
   basin_list[["landfrac"]] <- basin_object@landfrac
   basin_list[["lakeDepth"]] <- basin_object@lakeDepth
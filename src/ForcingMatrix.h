@@ -0,0 +1,27 @@
+#ifndef FORCINGMATRIX_H
+#define FORCINGMATRIX_H
+
+#include <Rcpp.h>
+#include "OutputMatrix.h"
+
+using namespace Rcpp;
+
+// climate forcing of the ModelContext (days x cells), read-only during the simulation
+// transposed once from the input matrix in initModel() (same layout as OutputMatrix), so row(day) are the values of all cells;
+// is not changed by a run, so runModelContext() can run the model again without copying the forcing
+class ForcingMatrix {
+public:
+	ForcingMatrix() {}
+	explicit ForcingMatrix(const NumericMatrix& M) : M(M) {}
+	
+	int nrow() const { return(M.nrow()); }
+	int ncol() const { return(M.ncol()); }
+	
+	double operator()(int day, int cell) const { return(M(day, cell)); }
+	const double* row(int day) const { return(M.row(day)); }
+	
+private:
+	OutputMatrix M;
+};
+
+#endif
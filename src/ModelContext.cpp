@@ -0,0 +1,36 @@
+#include <Rcpp.h>
+#include "ModelContext.h"
+#include "initModel.h"
+#include "initializeModel.h"
+
+using namespace Rcpp;
+using namespace std;
+
+
+// returns ModelContext behind the external pointer that was created with initModelContext()
+ModelContext& getModelContext(SEXP modelContext){
+	XPtr<ModelContext> ptr(modelContext);
+	if (ptr.get() == NULL) {
+		stop("modelContext is not valid, please create it with initModelContext()");
+	}
+	return(*ptr);
+}
+
+
+//' @title initModelContext
+//' @description creates a model (settings, basin input and all states) that is independent of other models in the R session
+//' @param ListConst list with all required information regarding basin and input (usually, object returned by basin.prepareRun())
+//' @param Settings vector of length 8 that is used to define settings (see runModel())
+//' @return modelContext as external pointer that can be used in runModelContext(), createWaterBalance() and routing()
+//' @export
+// [[Rcpp::export]]
+SEXP initModelContext(List ListConst, NumericVector Settings){
+	
+	XPtr<ModelContext> ptr(new ModelContext(), true); // is deleted by garbage collector of R
+	
+	defSettings(*ptr, Settings); //defines Settings
+	initModel(*ptr, ListConst); // defines Variables and Input data
+	initializeModel(*ptr); // initializes Vectors that defines fluxes and states in Model
+	
+	return(ptr);
+}
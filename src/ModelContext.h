@@ -0,0 +1,238 @@
+#ifndef MODELCONTEXT_H
+#define MODELCONTEXT_H
+
+#include <Rcpp.h>
+#include <vector>
+#include "ModelParameters.h"
+#include "RadiationTable.h"
+#include "ForcingMatrix.h"
+#include "WaterUseSchedule.h"
+
+using namespace std;
+using namespace Rcpp;
+
+// ModelContext owns everything that was declared as global variable in initModel.h and initializeModel.h before:
+// settings, basin input (climate, parameters), constants and all state and working vectors.
+// Every model (basin or parameter set) gets its own context, so several models can exist in one R session.
+// The context is filled by defSettings(), initModel() and initializeModel() and passed explicitly to all functions.
+struct ModelContext {
+
+	//SETTINGS
+	int waterUseType;
+	int flowVelocityType;
+	int GapYearType;
+	int WaterUseAllocationType;
+	int ReservoirType;
+	int splitType;
+	int calcLong;
+	int useSystemVals;
+	bool checkInterrupt = true; // Rcpp::checkUserInterrupt() is only allowed in the main thread (false in runModelBatch())
+	int simdLevel = 0; // instruction set of the vectorized daily kernels (see VectorMath.h), 0 = original scalar code
+
+	//CONSTANT FILES
+	List ListConst; // input list of the model (used to reset the context before every run)
+
+	// this makes a shallow copy, with the R object underlying
+	// cell parameters (albedo, G_Smax, GAREA, G_LAKAREA, ...) are copied into one block (see ModelParameters.h),
+	// so vectors that are changed during simulation (G_LAKAREA, G_RESAREA, G_BANKFULL) do not change the input
+	ModelParameters par;
+
+	String SystemValues;
+	int id;
+
+	// climate forcing (days x cells) is copied once in initModel(), so that the values of one day are next to each other (see ForcingMatrix.h)
+	ForcingMatrix Temp;
+	ForcingMatrix Rs;
+	ForcingMatrix Rl;
+	ForcingMatrix Prec; //WaterContent at the end of forstep
+	int cor_row;
+	NumericMatrix G_Elevation; //elevation of grid and subgrids
+	NumericMatrix NeighbouringCells; // neighbour cells where 0 indicates that there is no neighbour cell in the basin
+	// 4 3 2
+	// 5   1
+	// 6 7 8
+	IntegerVector GR;
+	RadiationTable radTable; // extraterrestrial radiation per grid row and DOY (only built if calcLong == 1)
+
+	NumericVector LAI_min;
+	NumericVector LAI_max;
+	NumericVector initDays;
+	NumericVector GLCT;
+	//LAI phenology, advanced day by day in updateLAIdaily()
+	int laiDay = -1; // day of the simulation period of dailyLai (-1 = phenology starts again at the first day)
+	vector<double> dailyLai; //Maximal Interception Storage of the day
+	vector<double> laiPrecSum;
+	vector<int> laiGrowingStatus;
+	vector<int> laiDaysSinceStart;
+
+	NumericMatrix Info_GW;
+	NumericMatrix Info_SW;
+	NumericMatrix Info_TF;
+	WaterUseSchedule waterUseSchedule; // daily water use of every month of the simulation period (WaterUseInitSchedule())
+	NumericVector YearlyMeanDemand;
+	vector<double> meanDemandDownstream; // YearlyMeanDemand of cell and its downstream cells [m³/yr] (WaterUseInitMeanDemand())
+	vector<double> meanDemandDaily; // mean demand of meanDemandYear [mm*km²/day] (WaterUseMeanDemandDaily())
+	int meanDemandYear = -1;
+
+	IntegerVector routeOrder;
+	IntegerVector outflowOrder; // obtained from routing input, modified
+
+	double maxCanopyStoragePerLAI; // 0.3 mm
+	double canopyEvapoExp; // 0.6666667 [-]
+	int array_size; //
+	double snowFreezeTemp; // 0°C
+	double snowMeltTemp; // 0
+	double runoffFracBuiltUp; // 0.5
+	double pcrit; // 12.5 mm/day
+	double k_g;
+	double lakeDepth; // 0.005 km --> 5000 mm
+	double lakeOutflowExp; // 1.5 [-]
+	double wetlandDepth; // 0.002 km --> 2000 mm
+	double wetlOutflowExp; // 2.5 [-]
+	double evapoReductionExp; // 3.32193
+	double evapoReductionExpReservoir; // 2.81383
+	int glo_storageFactor;
+	int loc_storageFactor;
+	int reservoir_dsc = 20; //downstream cells that are considered for water use of reservoir (for 5min always the same)
+	double defaultRiverVelocity; // = 86.4;	// [km/d] = 1 m/s
+
+	//SIMULATION PERIOD
+	// calendar of the simulation period, so that no Rcpp::Date is needed during the simulation (see initSimPeriod())
+	int ndays;
+	vector<int> SimYear;
+	vector<int> SimMonth;
+	vector<int> SimDay;
+	vector<int> SimDOY; // 1-365, 31.12. of leap years is set to 365
+
+	//OUTPUT
+	// output can be aggregated in time (see initOutputPeriods()), rows of the output matrices are then months, years or the whole period
+	int outputTimestep = 0; // 0 = daily, 1 = monthly, 2 = yearly, 3 = long-term mean
+	int nOutputPeriods;
+	vector<int> outputPeriod; // row of the output matrices for every day of the simulation period
+	vector<int> outputPeriodDays; // number of simulated days in every output period
+
+	//DAILY
+
+	//Creating working vectors
+	NumericVector G_PETnetShort;
+	NumericVector G_PETnetLong;
+	NumericVector dailyPET; // PET from land of the actual day
+	NumericVector dailyPETw; // PET from water of the actual day
+
+	NumericVector daily_prec_to_soil;
+	NumericVector dailySoilPET; //left energy for evaporation from soil (PET)
+	NumericVector dailyCanopyEvapo;
+	NumericVector dailySnowMelt; //Snowmelt (flux) per day
+	NumericVector dailySnowEvapo; //Sublimation from snow (flux) per day (no changes between sublimation and evaporation)
+	NumericVector thresh_elev; //help vector to avoid unlimited snow accumulation in high regions
+	NumericVector dailyEffPrec; //Water amount that goes to soil (snowmelt + precipitation (T > 0°C)
+	NumericVector immediate_runoff; //Water amount that is transformed directly to surface run-off
+	NumericVector dailyAET; // actual evaporation form soil
+	NumericVector daily_runoff; //amount of sealed ares in grid [-]
+	NumericVector soil_water_overflow; //amount of sealed ares in grid [-]
+	NumericVector daily_gw_recharge;
+	NumericVector G_dailyLocalSurfaceRunoff;
+	NumericVector G_dailyLocalGWRunoff;
+	NumericVector G_dailyUseGW;
+	vector<char> vectorFallback; // cells that a vectorized kernel could not simulate (see VectorMath.h)
+
+	//elevation bands of snow (built in initSnowBands())
+	int nSnowBands; // sub-grids of a cell (rows of G_snowWaterEquivalent)
+	vector<double> snowTempOffset; // temperature difference of band e to the mean elevation of cell: snowTempOffset[cell * nSnowBands + e]
+	vector<double> snowMaxTempOffset; // largest offset of a cell (coldest band)
+	vector<double> snowBandFlux; // working memory of dailySnow(): sublimation, rain and snow melt of the bands of one cell
+
+	//active cells of the daily processes, rebuilt every day (other cells are finished without the full calculation)
+	vector<char> snowCovered; // 0 if no subgrid of the cell has snow (set in dailySnow(), 1 for all cells before the first day)
+	vector<int> snowActiveCells; // cells with snow or freezing temperature in a subgrid (dailySnow())
+
+	//initiliazing storages
+	NumericVector G_canopyWaterContent; //canopy storage is defined (0 content)
+	NumericVector G_snow; //Snow storage for every cell and per day
+	NumericMatrix G_snowWaterEquivalent; //Snow storage for every subgrid cell and per day
+	NumericVector G_soilWaterContent; //soil storage
+	NumericVector G_groundwater; // groundwater storage
+
+	//routing schedule (built once in initRoutingSchedule())
+	// cells of routing step n are routeCells[routeStepStart[n]] ... routeCells[routeStepStart[n+1] - 1]
+	int nRouteSteps;
+	vector<int> routeStepStart; // length nRouteSteps + 1
+	vector<int> routeCells; // cell indices sorted by routeOrder (ascending cell index within a step)
+	vector<int> routePosition; // position of every cell in routeCells
+	vector<int> upstreamStart; // upstream cells of cell i are upstreamCells[upstreamStart[i]] ... upstreamCells[upstreamStart[i+1] - 1]
+	vector<int> upstreamCells; // sorted by position in routing schedule
+	bool routeStepsIndependent; // true if cells of a routing step do not depend on each other (always true for routing levels from calcRoutingLevels())
+	int nThreadsRouting = 1; // cells of one routing step are simulated in parallel (OpenMP) if > 1
+	int minCellsParallel = 64; // routing steps (and water-use colours) with fewer cells are simulated serial, also if nThreadsRouting > 1 (overhead of threads)
+
+	//subtrees of the routing network (built in initRoutingSubtrees()), used for routing with temporal blocking
+	bool routingBlocked = false; // subtrees are simulated for blocks of days if there is no water use (see simulateRoutingBlocked())
+	int maxSubtreeSize = 256; // cells of a subtree (states should fit in cache)
+	int nSubtrees;
+	vector<int> subtreeOf; // subtree of every cell
+	vector<int> subtreeStart; // cells of subtree s are subtreeCells[subtreeStart[s]] ... subtreeCells[subtreeStart[s+1] - 1]
+	vector<int> subtreeCells; // order of routing schedule, so the last cell is the outlet of the subtree
+	int nSubtreeLevels;
+	vector<int> subtreeLevelStart; // subtrees of level l are subtreeOrder[subtreeLevelStart[l]] ... subtreeOrder[subtreeLevelStart[l+1] - 1]
+	vector<int> subtreeOrder; // subtrees of one level only depend on subtrees of lower levels
+
+	//downstream paths (built in initDownstreamPaths() after CheckResType()), used for water use of reservoirs and surface water
+	// the next reservoir_dsc downstream cells of cell are downstreamCells[downstreamStart[cell]] ... downstreamCells[downstreamStart[cell+1] - 1]
+	vector<int> downstreamStart;
+	vector<int> downstreamCells; // cell indices (0 = first cell), ordered from the cell to the outlet
+	vector<double> downstreamCoeff; // allocation coefficient of the downstream cell (par.wb.allocCoeff())
+	vector<int> downstreamReservoirEnd; // end of the path that gets water from a reservoir in cell (before the next reservoir)
+
+	//spatial allocation of water use (built in initWaterUseColours())
+	vector<int> neighbourCells; // NeighbouringCells as cell indices (0 = first cell), 8 per cell, -1 = no neighbour cell
+	int nWaterUseColours;
+	vector<int> waterUseColourStart; // cells of colour c are waterUseColourCells[waterUseColourStart[c]] ... waterUseColourCells[waterUseColourStart[c+1] - 1]
+	vector<int> waterUseColourCells;
+
+	// ROUTING
+
+	//Creating working vectors
+	NumericVector G_riverOutflow; // only for routing, needs ot be set to zero for every day
+	NumericVector QA_river; //has always river outflow from previous time step
+	NumericVector S_river; //has always river inflow from previous time step
+
+	NumericVector locLake_overflow;
+	NumericVector locLake_outflow;
+	NumericVector S_locLakeStorage;
+	NumericVector locLake_evapo;
+	NumericVector locLake_inflow;
+
+	NumericVector locWetland_overflow;
+	NumericVector locWetland_outflow;
+	NumericVector S_locWetlandStorage;
+	NumericVector locWetland_evapo;
+	NumericVector locWetland_inflow;
+
+	NumericVector gloLake_overflow;
+	NumericVector gloLake_outflow;
+	NumericVector S_gloLakeStorage;
+	NumericVector gloLake_evapo;
+	NumericVector gloLake_inflow;
+
+	NumericVector Res_outflow;
+	NumericVector S_ResStorage;
+	NumericVector Res_evapo;
+	NumericVector Res_inflow;
+	NumericVector Res_overflow;
+
+	NumericVector gloWetland_overflow;
+	NumericVector gloWetland_outflow;
+	NumericVector S_gloWetlandStorage;
+	NumericVector gloWetland_evapo;
+	NumericVector gloWetland_inflow;
+
+	WaterUseDay dailyUse; // water use of the actual day (slice of waterUseSchedule)
+	NumericVector G_totalUnsatisfiedUse;
+	vector<double> waterUseDeficit; // deficits that reached a cell, reservoir_dsc per cell (WaterUseAllocationType 3, see SpatialAllocationNetwork())
+	vector<double> waterUseKeep; // fraction of the deficits in a cell that is not satisfied by the cell (WaterUseAllocationType 3)
+	NumericVector G_actualUse;
+};
+
+ModelContext& getModelContext(SEXP modelContext);
+
+#endif
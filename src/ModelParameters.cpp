@@ -0,0 +1,116 @@
+#include <Rcpp.h>
+#include <stdint.h>
+#include "ModelParameters.h"
+
+using namespace Rcpp;
+using namespace std;
+
+// reserves an aligned array of n values in the block
+// (first call of layout(): only the size is counted, second call: field is set)
+template <typename T>
+void ModelParameters::addField(T*& field, size_t n){
+	field = (base == NULL) ? NULL : (T*) (base + used);
+	used += (n * sizeof(T) + alignment - 1) / alignment * alignment;
+}
+
+// copies an input vector of ListConst into a field of the block (n values at most)
+template <typename T, typename V>
+static void copyField(T* field, const V& x, size_t n){
+	const size_t len = min((size_t) x.length(), n);
+	for (size_t i = 0; i < len; i++){
+		field[i] = (T) x[i];
+	}
+}
+
+// order of the fields in the block: grouped by kernel
+void ModelParameters::layout(List ListConst){
+
+	nCells = as<int>(ListConst["array_size"]);
+
+	addField(rad.albedo, nCells);
+	addField(rad.albedoSnow, nCells);
+	addField(rad.emissivity, nCells);
+	addField(rad.alphaPT, nCells);
+	addField(rad.G_ARID_HUMID, nCells);
+
+	addField(soil.degreeDayFactor, nCells);
+	addField(soil.GBUILTUP, nCells);
+	addField(soil.G_Smax, nCells);
+	addField(soil.G_GAMMA_HBV, nCells);
+	addField(soil.maxDailyPET, nCells);
+	addField(soil.G_RG_max, nCells);
+	addField(soil.G_gwFactor, nCells);
+	addField(soil.G_TEXTURE, nCells);
+	addField(soil.Splitfactor, nCells);
+	addField(soil.G_ARID_HUMID, nCells);
+
+	addField(wb.GAREA, nCells);
+	addField(wb.landfrac, nCells);
+	addField(wb.G_LOCLAK, nCells);
+	addField(wb.G_LOCWET, nCells);
+	addField(wb.G_GLOLAK, nCells);
+	addField(wb.G_GLOWET, nCells);
+	addField(wb.G_LAKAREA, nCells);
+	addField(wb.G_RESAREA, nCells);
+	addField(wb.G_STORAGE_CAPACITY, nCells);
+	addField(wb.G_MEAN_INFLOW, nCells);
+	addField(wb.G_START_MONTH, nCells);
+	addField(wb.G_RES_TYPE, nCells);
+	addField(wb.G_ALLOC_COEFF, as<NumericMatrix>(ListConst["G_ALLOC_COEFF.20"]).length());
+
+	addField(river.G_riverLength, nCells);
+	addField(river.G_riverSlope, nCells);
+	addField(river.G_riverRoughness, nCells);
+	addField(river.G_BANKFULL, nCells);
+}
+
+// builds the block from the parameters in ListConst
+void ModelParameters::init(List ListConst){
+
+	// size of the block, then the fields are placed into it
+	base = NULL;
+	used = 0;
+	layout(ListConst);
+	block.assign(used + alignment, 0);
+	base = block.data() + (alignment - (uintptr_t) block.data() % alignment) % alignment;
+	used = 0;
+	layout(ListConst);
+
+	copyField(rad.albedo, as<NumericVector>(ListConst["albedo"]), nCells);
+	copyField(rad.albedoSnow, as<NumericVector>(ListConst["albedoSnow"]), nCells);
+	copyField(rad.emissivity, as<NumericVector>(ListConst["emissivity"]), nCells);
+	copyField(rad.alphaPT, as<NumericVector>(ListConst["alphaPT"]), nCells);
+	copyField(rad.G_ARID_HUMID, as<IntegerVector>(ListConst["G_ARID_HUMID"]), nCells);
+
+	copyField(soil.degreeDayFactor, as<NumericVector>(ListConst["degreeDayFactor"]), nCells);
+	copyField(soil.GBUILTUP, as<NumericVector>(ListConst["GBUILTUP"]), nCells);
+	copyField(soil.G_Smax, as<NumericVector>(ListConst["G_Smax"]), nCells);
+	copyField(soil.G_GAMMA_HBV, as<NumericVector>(ListConst["G_GAMMA_HBV"]), nCells);
+	copyField(soil.maxDailyPET, as<NumericVector>(ListConst["maxDailyPET"]), nCells);
+	copyField(soil.G_RG_max, as<NumericVector>(ListConst["G_RG_max"]), nCells);
+	copyField(soil.G_gwFactor, as<NumericVector>(ListConst["G_gwFactor"]), nCells);
+	copyField(soil.G_TEXTURE, as<NumericVector>(ListConst["G_TEXTURE"]), nCells);
+	copyField(soil.Splitfactor, as<NumericVector>(ListConst["Splitfactor"]), nCells);
+	copyField(soil.G_ARID_HUMID, as<IntegerVector>(ListConst["G_ARID_HUMID"]), nCells);
+
+	copyField(wb.GAREA, as<NumericVector>(ListConst["GAREA"]), nCells);
+	copyField(wb.landfrac, as<NumericVector>(ListConst["landfrac"]), nCells);
+	copyField(wb.G_LOCLAK, as<IntegerVector>(ListConst["G_LOCLAK"]), nCells);
+	copyField(wb.G_LOCWET, as<IntegerVector>(ListConst["G_LOCWET"]), nCells);
+	copyField(wb.G_GLOLAK, as<IntegerVector>(ListConst["G_GLOLAK"]), nCells);
+	copyField(wb.G_GLOWET, as<IntegerVector>(ListConst["G_GLOWET"]), nCells);
+	copyField(wb.G_LAKAREA, as<NumericVector>(ListConst["G_LAKAREA"]), nCells);
+	copyField(wb.G_RESAREA, as<NumericVector>(ListConst["G_RESAREA"]), nCells);
+	copyField(wb.G_STORAGE_CAPACITY, as<NumericVector>(ListConst["G_STORAGE_CAPACITY"]), nCells);
+	copyField(wb.G_MEAN_INFLOW, as<NumericVector>(ListConst["G_MEAN_INFLOW"]), nCells);
+	copyField(wb.G_START_MONTH, as<IntegerVector>(ListConst["G_START_MONTH"]), nCells);
+	copyField(wb.G_RES_TYPE, as<IntegerVector>(ListConst["G_RES_TYPE"]), nCells);
+	NumericMatrix allocCoeff = as<NumericMatrix>(ListConst["G_ALLOC_COEFF.20"]);
+	copyField(wb.G_ALLOC_COEFF, allocCoeff, allocCoeff.length());
+	wb.nAllocCoeff = allocCoeff.nrow();
+
+	copyField(river.G_riverLength, as<NumericVector>(ListConst["G_riverLength"]), nCells);
+	copyField(river.G_riverSlope, as<NumericVector>(ListConst["G_riverSlope"]), nCells);
+	copyField(river.G_riverRoughness, as<NumericVector>(ListConst["G_riverRoughness"]), nCells);
+	copyField(river.G_BANKFULL, as<NumericVector>(ListConst["G_BANKFULL"]), nCells);
+}
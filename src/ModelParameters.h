@@ -0,0 +1,99 @@
+#ifndef MODELPARAMETERS_H
+#define MODELPARAMETERS_H
+
+#include <Rcpp.h>
+#include <vector>
+
+using namespace std;
+using namespace Rcpp;
+
+// floating point type of the cell parameters: double (default, same values as in ListConst)
+// or float (compile with -DWATERGAP_FLOAT_PARAMETERS, half the memory traffic, results differ slightly)
+#ifdef WATERGAP_FLOAT_PARAMETERS
+typedef float param_t;
+#else
+typedef double param_t;
+#endif
+
+// parameters of PET (dailyEvaporation2(), dailyEstimateLongwave())
+struct RadiationParameters {
+	param_t* albedo;
+	param_t* albedoSnow;
+	param_t* emissivity;
+	param_t* alphaPT;
+	int* G_ARID_HUMID;
+};
+
+// parameters of snow, immediate run-off, soil and run-off splitting
+struct SoilParameters {
+	param_t* degreeDayFactor;
+	param_t* GBUILTUP;
+	param_t* G_Smax; //size of soil layer/storage
+	param_t* G_GAMMA_HBV; //calibrated gamma value
+	param_t* maxDailyPET;
+	param_t* G_RG_max;
+	param_t* G_gwFactor;
+	param_t* G_TEXTURE;
+	param_t* Splitfactor;
+	int* G_ARID_HUMID;
+};
+
+// parameters of local/global lakes, wetlands and reservoirs (and water use from them)
+struct WaterBodyParameters {
+	param_t* GAREA;
+	param_t* landfrac;
+	int* G_LOCLAK; // % of cell that belongs to local lake
+	int* G_LOCWET; // % of cell that belongs to local wetland
+	int* G_GLOLAK; // % of cell that belongs to global lake (including resevroirs at the moment)
+	int* G_GLOWET; // % of cell that belongs to global wetland
+	param_t* G_LAKAREA; // km² global lake area defined in outlet cell of global lake (changed in CheckResType())
+	param_t* G_RESAREA; // km² reservoir area defined in outlet cell of reservoirs (changed in CheckResType())
+	param_t* G_STORAGE_CAPACITY;
+	param_t* G_MEAN_INFLOW;
+	int* G_START_MONTH;
+	int* G_RES_TYPE;
+	param_t* G_ALLOC_COEFF; // allocation coefficients of downstream cells (nAllocCoeff values per cell)
+	int nAllocCoeff;
+
+	// allocation coefficient of downstream cell i (0 = first cell downstream) of a reservoir in cell
+	param_t allocCoeff(int i, int cell) const { return(G_ALLOC_COEFF[(size_t) cell * nAllocCoeff + i]); }
+};
+
+// parameters of the river segments (routingRiver(), getRiverVelocity())
+struct RiverParameters {
+	param_t* G_riverLength;
+	param_t* G_riverSlope;
+	param_t* G_riverRoughness;
+	param_t* G_BANKFULL; // BANKFULL flow in m³/s (is simulation product, set to 0.05 at least in getRiverVelocity())
+};
+
+// cell parameters of the basin in one contiguous block, built once in initModel() from ListConst
+// every field is an aligned array (cells next to each other) and the fields that are read by one kernel
+// are next to each other as well; it is a copy, so changes during the simulation are reset by initModel()
+// does not use the R API after init(), so it can be read in worker threads
+class ModelParameters {
+public:
+	RadiationParameters rad;
+	SoilParameters soil;
+	WaterBodyParameters wb;
+	RiverParameters river;
+	size_t nCells; // length of the fields (cells of the basin)
+
+	ModelParameters() : nCells(0), base(NULL), used(0) {}
+	ModelParameters(const ModelParameters&) = delete; // fields point into the block
+	ModelParameters& operator=(const ModelParameters&) = delete;
+
+	void init(List ListConst);
+
+private:
+	static const size_t alignment = 64; // cache line
+
+	vector<char> block;
+	char* base; // first aligned byte of block (NULL while the size of the block is counted)
+	size_t used;
+
+	void layout(List ListConst);
+	template <typename T> void addField(T*& field, size_t n);
+};
+
+#endif
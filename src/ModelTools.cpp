@@ -1,5 +1,6 @@
 #include <Rcpp.h>
 #include <math.h>
+#include <vector>
 #include "ModelTools.h"
 
 using namespace Rcpp;
@@ -79,6 +80,50 @@ IntegerVector sortIt(IntegerVector vec){
     return vecCopy;
 }
 
+// derives routing levels from the flow network: level of a cell is the length of the longest upstream flow path
+// (1 = no upstream cell), so every cell only depends on cells of lower levels
+// outflowOrder is the downstream cell of every cell (1=1st cell of basin, negative value = outlet), returns routing level of every cell (used as routeOrder)
+IntegerVector calcRoutingLevels(const IntegerVector& outflowOrder){
+
+	const int ng = outflowOrder.length();
+	IntegerVector levels (ng, 1);
+	vector<int> nUpstream (ng, 0); // number of upstream cells that are not levelled yet
+	vector<int> readyCells; // cells with all upstream cells levelled
+	readyCells.reserve(ng);
+
+	for (int i = 0; i < ng; i++){
+		const int downstreamCell = outflowOrder[i];
+		if (downstreamCell > ng || downstreamCell == 0) {
+			stop("outflow of cell %i is not part of the basin", i + 1);
+		}
+		if (downstreamCell > 0) {
+			nUpstream[downstreamCell - 1]++;
+		}
+	}
+	for (int i = 0; i < ng; i++){
+		if (nUpstream[i] == 0) {
+			readyCells.push_back(i); // headwater cells
+		}
+	}
+
+	// Kahn: a cell is levelled after all upstream cells, so its level is final
+	for (int k = 0; k < (int) readyCells.size(); k++){
+		const int cell = readyCells[k];
+		const int downstreamCell = outflowOrder[cell] - 1;
+		if (downstreamCell < 0) {
+			continue; // outlet
+		}
+		levels[downstreamCell] = max(levels[downstreamCell], levels[cell] + 1);
+		if (--nUpstream[downstreamCell] == 0) {
+			readyCells.push_back(downstreamCell);
+		}
+	}
+	if ((int) readyCells.size() != ng) {
+		stop("flow network of basin contains a loop - routing levels can not be defined");
+	}
+	return levels;
+}
+
 //' @title sumVector
 //' @description Function that sums up a vector
 //' @param vec Numericvector that is sumed up
@@ -100,15 +145,12 @@ double sumVector(NumericVector vec){ //should be written more generic but don't
 //' @return number of days of specified month in specified year as integer
 // [[Rcpp::export]]
 int numberOfDaysInMonth(int month, int year){
-	Date start = Date(month, 1, year); // 2000-01-02 Date(mon, day, year)
-	int newMonth = month;
-	int count = 0;
-	while (newMonth == month){
-		start = start + 1;
-		newMonth = start.getMonth(); 
-		count ++;
+	// computed without Rcpp::Date (not thread-safe), so it can be used during the simulation in runModelBatch()
+	const int daysInMonth[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+	if ((month == 2) && (numberOfDaysInYear(year) == 366)){
+		return(29);
 	}
-	return(count);
+	return(daysInMonth[month-1]);
 }
 
 //' @title numberOfDaysInYear
@@ -117,13 +159,108 @@ int numberOfDaysInMonth(int month, int year){
 //' @return number of days of specified year as integer
 // [[Rcpp::export]]
 int numberOfDaysInYear(int year){
-	Date start = Date(1, 1, year); // 2000-01-02 Date(mon, day, year)
-	int newYear = year;
-	int count = 0;
-	while (newYear == year){
-		start = start + 1;
-		newYear = start.getYear();
-		count ++;
+	// gregorian calendar (same as Rcpp::Date)
+	if (((year % 4 == 0) && (year % 100 != 0)) || (year % 400 == 0)){
+		return(366);
 	}
-	return(count);
-}
\ No newline at end of file
+	return(365);
+}
+
+// saves values of one day as row of an output matrix, output that is not allocated (not requested) is skipped
+// for aggregated output (see initOutputPeriods()) the values are summed up in the row of the output period
+void saveDay(ModelContext& ctx, OutputMatrix& M, int day, const NumericVector& values){
+	if (M.nrow() == 0){
+		return;
+	}
+	if (ctx.outputTimestep == 0){
+		double* row = M.row(day);
+		for (int cell = 0; cell < ctx.array_size; cell++){
+			row[cell] = values[cell];
+		}
+	} else {
+		double* row = M.row(ctx.outputPeriod[day]);
+		for (int cell = 0; cell < ctx.array_size; cell++){
+			row[cell] += values[cell];
+		}
+	}
+}
+
+// same as saveDay() for a single cell
+void saveDayCell(ModelContext& ctx, OutputMatrix& M, int day, int cell, double value){
+	if (M.nrow() == 0){
+		return;
+	}
+	if (ctx.outputTimestep == 0){
+		M(day, cell) = value;
+	} else {
+		M(ctx.outputPeriod[day], cell) += value;
+	}
+}
+
+// same as saveDay() for output with one value per day (e.g. discharge at the outlet)
+void saveDayValue(ModelContext& ctx, NumericVector& v, int day, double value){
+	if (v.size() == 0){
+		return;
+	}
+	if (ctx.outputTimestep == 0){
+		v[day] = value;
+	} else {
+		v[ctx.outputPeriod[day]] += value;
+	}
+}
+
+// sums of aggregated output are divided by the number of simulated days of the output period -> mean values
+void averageOutputPeriods(ModelContext& ctx, OutputMatrix& M){
+	if ((M.nrow() == 0) || (ctx.outputTimestep == 0)){
+		return;
+	}
+	for (int row = 0; row < ctx.nOutputPeriods; row++){
+		if (ctx.outputPeriodDays[row] > 0){
+			for (int cell = 0; cell < M.ncol(); cell++){
+				M(row, cell) /= ctx.outputPeriodDays[row];
+			}
+		}
+	}
+}
+
+void averageOutputPeriods(ModelContext& ctx, NumericVector& v){
+	if ((v.size() == 0) || (ctx.outputTimestep == 0)){
+		return;
+	}
+	for (int row = 0; row < ctx.nOutputPeriods; row++){
+		if (ctx.outputPeriodDays[row] > 0){
+			v[row] /= ctx.outputPeriodDays[row];
+		}
+	}
+}
+
+// output of one variable as R matrix (uses R API -> only in main thread), the buffer is freed afterwards
+NumericMatrix outputToMatrix(ModelContext& ctx, OutputMatrix& M){
+	averageOutputPeriods(ctx, M);
+	NumericMatrix R = M.toMatrix();
+	M.clear();
+	return(R);
+}
+
+// output specification from the names given in R (NULL -> all variables are kept) and the time step of the output
+OutputSpec getOutputSpec(Nullable<CharacterVector> outputVars, string outputTimestep){
+	OutputSpec spec;
+	if (outputVars.isNotNull()){
+		vector<string> vars = as< vector<string> >(outputVars.get());
+		spec.all = false;
+		spec.vars.insert(vars.begin(), vars.end());
+	}
+	
+	if (outputTimestep == "daily") {
+		spec.timestep = 0;
+	} else if (outputTimestep == "monthly") {
+		spec.timestep = 1;
+	} else if (outputTimestep == "yearly") {
+		spec.timestep = 2;
+	} else if (outputTimestep == "longterm") {
+		spec.timestep = 3;
+	} else {
+		stop("outputTimestep should be 'daily', 'monthly', 'yearly' or 'longterm'");
+	}
+	return(spec);
+}
@@ -3,15 +3,36 @@
 #define MODELTOOLS_H
 
 #include <Rcpp.h>
+#include <set>
+#include <string>
+#include "ModelContext.h"
+#include "OutputMatrix.h"
 
 using namespace std;
 using namespace Rcpp;
 
+// output variables that are kept during a simulation (see runModel()), names are the path in the output list (e.g. "River$Discharge")
+struct OutputSpec {
+	bool all = true; // all variables are kept (no output specification given)
+	set<string> vars;
+	int timestep = 0; // 0 = daily, 1 = monthly, 2 = yearly, 3 = long-term mean (see initOutputPeriods())
+	
+	bool keep(const string& name) const { return(all || (vars.count(name) > 0)); }
+};
+
 IntegerVector findNumberInVector(int number, IntegerVector vec);
 IntegerVector findUniqueValues(IntegerVector vec);
 IntegerVector sortIt(IntegerVector vec);
+IntegerVector calcRoutingLevels(const IntegerVector& outflowOrder);
 double sumVector(NumericVector vec);
 int numberOfDaysInMonth(int month, int year);
 int numberOfDaysInYear(int year);
+void saveDay(ModelContext& ctx, OutputMatrix& M, int day, const NumericVector& values);
+void saveDayCell(ModelContext& ctx, OutputMatrix& M, int day, int cell, double value);
+void saveDayValue(ModelContext& ctx, NumericVector& v, int day, double value);
+void averageOutputPeriods(ModelContext& ctx, OutputMatrix& M);
+void averageOutputPeriods(ModelContext& ctx, NumericVector& v);
+NumericMatrix outputToMatrix(ModelContext& ctx, OutputMatrix& M);
+OutputSpec getOutputSpec(Nullable<CharacterVector> outputVars, string outputTimestep = "daily");
 
 #endif
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include <Rcpp.h>
+#include <algorithm>
+#include "OutputMatrix.h"
+
+using namespace Rcpp;
+using namespace std;
+
+// copy of an R matrix (days x cells), e.g. input of routing() from R or climate forcing (see ForcingMatrix.h)
+// done in tiles like toMatrix()
+OutputMatrix::OutputMatrix(const NumericMatrix& M) : values((size_t) M.nrow() * M.ncol()), nDays(M.nrow()), nCells(M.ncol()) {
+	
+	const int tile = 64;
+	
+	for (int dayStart = 0; dayStart < nDays; dayStart += tile){
+		const int dayEnd = min(dayStart + tile, nDays);
+		for (int cellStart = 0; cellStart < nCells; cellStart += tile){
+			const int cellEnd = min(cellStart + tile, nCells);
+			for (int cell = cellStart; cell < cellEnd; cell++){
+				for (int day = dayStart; day < dayEnd; day++){
+					values[(size_t) day * nCells + cell] = M(day, cell);
+				}
+			}
+		}
+	}
+}
+
+// transposes the values into an R matrix (days x cells)
+// done in tiles, so that reading and writing both stay within a few cache lines / pages
+NumericMatrix OutputMatrix::toMatrix() const {
+	
+	const int tile = 64;
+	NumericMatrix M(nDays, nCells);
+	
+	for (int dayStart = 0; dayStart < nDays; dayStart += tile){
+		const int dayEnd = min(dayStart + tile, nDays);
+		for (int cellStart = 0; cellStart < nCells; cellStart += tile){
+			const int cellEnd = min(cellStart + tile, nCells);
+			for (int cell = cellStart; cell < cellEnd; cell++){
+				for (int day = dayStart; day < dayEnd; day++){
+					M(day, cell) = values[(size_t) day * nCells + cell];
+				}
+			}
+		}
+	}
+	return(M);
+}
+
+// frees the memory (e.g. after the values were transposed into the output list)
+void OutputMatrix::clear(){
+	vector<double>().swap(values);
+	nDays = 0;
+	nCells = 0;
+}
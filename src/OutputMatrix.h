@@ -0,0 +1,38 @@
+#ifndef OUTPUTMATRIX_H
+#define OUTPUTMATRIX_H
+
+#include <Rcpp.h>
+#include <vector>
+
+using namespace std;
+using namespace Rcpp;
+
+// output of one variable during the simulation (days x cells)
+// the values of one day are stored next to each other, so saving a day does not write with stride ndays
+// into a column-major R matrix; it is transposed once into a NumericMatrix when the output list is created (toMatrix())
+// the climate forcing of the ModelContext is stored the same way (see ForcingMatrix.h)
+// does not use the R API (except the conversions from/to NumericMatrix), so it can be written in worker threads
+class OutputMatrix {
+public:
+	OutputMatrix() : nDays(0), nCells(0) {}
+	OutputMatrix(int nDays, int nCells) : values((size_t) nDays * nCells), nDays(nDays), nCells(nCells) {}
+	explicit OutputMatrix(const NumericMatrix& M);
+	
+	int nrow() const { return(nDays); } // 0 -> not allocated (not requested)
+	int ncol() const { return(nCells); }
+	
+	double& operator()(int day, int cell) { return(values[(size_t) day * nCells + cell]); }
+	double operator()(int day, int cell) const { return(values[(size_t) day * nCells + cell]); }
+	double* row(int day) { return(&values[(size_t) day * nCells]); }
+	const double* row(int day) const { return(&values[(size_t) day * nCells]); }
+	
+	NumericMatrix toMatrix() const;
+	void clear();
+	
+private:
+	vector<double> values;
+	int nDays;
+	int nCells;
+};
+
+#endif
@@ -0,0 +1,52 @@
+#include <Rcpp.h>
+#include <math.h>
+#include <algorithm>
+#include "RadiationTable.h"
+
+using namespace Rcpp;
+using namespace std;
+
+// calculates the table for the unique rows in GR (same formulas as before in dailyEstimateLongwave() and dailyEstimateShortwave())
+void RadiationTable::init(const IntegerVector& GR, int cor_row, bool fullDegree){
+
+	const double pi = 3.141592653589793;
+	const double pi_180 = pi / 180.0;
+	const double pi2_365 = 2. * pi / 365.0;
+	const double cellsInDegree = 12;
+
+	// unique rows of the basin
+	vector<int> rows(GR.begin(), GR.end());
+	sort(rows.begin(), rows.end());
+	rows.erase(unique(rows.begin(), rows.end()), rows.end());
+
+	rowIndex.resize(GR.length());
+	for (int cell = 0; cell < GR.length(); cell++){
+		rowIndex[cell] = lower_bound(rows.begin(), rows.end(), GR[cell]) - rows.begin();
+	}
+
+	// solar declination angle (in radians) and relative distance earth - sun
+	double declination_angle[365];
+	double dist_es[365];
+	for (int DOY = 1; DOY <= 365; DOY++){
+		declination_angle[DOY - 1] = asin(0.39795 * cos(0.2163108 + 2. * atan(0.9671396 * tan(0.00860 * (DOY - 186)))));
+		dist_es[DOY - 1] = 1. + 0.033 * cos(pi2_365 * DOY);
+	}
+
+	ext_rad.resize(rows.size() * 365);
+	N.resize(rows.size() * 365);
+	for (size_t i = 0; i < rows.size(); i++){
+		// latitude of the site in radians
+		double lat = fullDegree ? (double) ((rows[i] + cor_row) / (int) cellsInDegree) : (rows[i] + cor_row) / cellsInDegree;
+		double theta = -(lat - 90. -1./(2.*cellsInDegree)) * pi_180;  //changed for WaterGAP3
+
+		for (int d = 0; d < 365; d++){
+			// sunset hour angle (in radians) - //eigentlich omega_1, so bezeichnet in dis kaspar A.3
+			double omega_s = max( min( ((sin(theta) * sin(declination_angle[d])) / (cos(theta) * cos(declination_angle[d]))), 1.) , -1. ); //gl(A.8)
+			omega_s = pi - acos(omega_s);//omega_s (stundenwinkel) wird nach kaspars konvention aus omega_1 berechnet
+			N[i * 365 + d] = 24/pi * omega_s;	// astronomisch mögliche Sonnenscheindauer nach Forsythe 1995
+			// extraterrestrial radiation [mm/day]
+			ext_rad[i * 365 + d] = ( 15.392 * dist_es[d] * (omega_s * sin(theta) * sin(declination_angle[d]) +
+					  cos(theta) * cos(declination_angle[d]) * sin(omega_s)) ); //Anhang A.2 Dis Kaspar
+		}
+	}
+}
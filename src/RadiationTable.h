@@ -0,0 +1,32 @@
+#ifndef RADIATIONTABLE_H
+#define RADIATIONTABLE_H
+
+#include <Rcpp.h>
+#include <vector>
+
+using namespace std;
+using namespace Rcpp;
+
+// astronomical quantities of the radiation estimation after Kaspar 2004 (dailyEstimateLongwave(), dailyEstimateShortwave())
+// they only depend on the grid row (latitude) and the day of the year, so they are calculated once
+// for every unique row of the basin and DOY 1-365 instead of for every cell and day
+// does not use the R API after init(), so it can be read in worker threads
+class RadiationTable {
+public:
+	// fullDegree: latitude of the row is calculated with integer division, i.e. in full degrees (as in dailyEstimateShortwave())
+	void init(const IntegerVector& GR, int cor_row, bool fullDegree);
+
+	// extraterrestrial radiation [mm/day] (S0)
+	double extRad(int cell, int DOY) const { return(ext_rad[index(cell, DOY)]); }
+	// astronomically possible sunshine duration [h] (Forsythe 1995)
+	double sunshineHours(int cell, int DOY) const { return(N[index(cell, DOY)]); }
+
+private:
+	vector<int> rowIndex; // table row of every cell
+	vector<double> ext_rad; // 365 values per unique grid row
+	vector<double> N;
+
+	size_t index(int cell, int DOY) const { return((size_t) rowIndex[cell] * 365 + (DOY - 1)); }
+};
+
+#endif
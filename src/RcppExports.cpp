@@ -10,6 +10,18 @@ Rcpp::Rostream<true>&  Rcpp::Rcout = Rcpp::Rcpp_cout_get();
 Rcpp::Rostream<false>& Rcpp::Rcerr = Rcpp::Rcpp_cerr_get();
 #endif
 
+// initModelContext
+SEXP initModelContext(List ListConst, NumericVector Settings);
+RcppExport SEXP _WaterGAPLite_initModelContext(SEXP ListConstSEXP, SEXP SettingsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type ListConst(ListConstSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Settings(SettingsSEXP);
+    rcpp_result_gen = Rcpp::wrap(initModelContext(ListConst, Settings));
+    return rcpp_result_gen;
+END_RCPP
+}
 // findNumberInVector
 IntegerVector findNumberInVector(int number, IntegerVector vec);
 RcppExport SEXP _WaterGAPLite_findNumberInVector(SEXP numberSEXP, SEXP vecSEXP) {
@@ -78,69 +90,27 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
-// WaterUseConsumGW
-double WaterUseConsumGW(int cell, NumericVector GroundwaterStorage, const NumericMatrix dailyUse);
-RcppExport SEXP _WaterGAPLite_WaterUseConsumGW(SEXP cellSEXP, SEXP GroundwaterStorageSEXP, SEXP dailyUseSEXP) {
+// subtractWaterUseSW
+List subtractWaterUseSW(SEXP modelContext, NumericVector useSW);
+RcppExport SEXP _WaterGAPLite_subtractWaterUseSW(SEXP modelContextSEXP, SEXP useSWSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< int >::type cell(cellSEXP);
-    Rcpp::traits::input_parameter< NumericVector >::type GroundwaterStorage(GroundwaterStorageSEXP);
-    Rcpp::traits::input_parameter< const NumericMatrix >::type dailyUse(dailyUseSEXP);
-    rcpp_result_gen = Rcpp::wrap(WaterUseConsumGW(cell, GroundwaterStorage, dailyUse));
+    Rcpp::traits::input_parameter< SEXP >::type modelContext(modelContextSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type useSW(useSWSEXP);
+    rcpp_result_gen = Rcpp::wrap(subtractWaterUseSW(modelContext, useSW));
     return rcpp_result_gen;
 END_RCPP
 }
-// WaterUseCalcMeanDemandDaily
-NumericVector WaterUseCalcMeanDemandDaily(int year, int GapYearType);
-RcppExport SEXP _WaterGAPLite_WaterUseCalcMeanDemandDaily(SEXP yearSEXP, SEXP GapYearTypeSEXP) {
-BEGIN_RCPP
-    Rcpp::RObject rcpp_result_gen;
-    Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< int >::type year(yearSEXP);
-    Rcpp::traits::input_parameter< int >::type GapYearType(GapYearTypeSEXP);
-    rcpp_result_gen = Rcpp::wrap(WaterUseCalcMeanDemandDaily(year, GapYearType));
-    return rcpp_result_gen;
-END_RCPP
-}
-// WaterUseCalcDaily
-void WaterUseCalcDaily(int waterUseType, NumericMatrix dailyUse, int year, int month, int StartYear, NumericMatrix Info_GW, NumericMatrix Info_SW, NumericMatrix Info_TF);
-RcppExport SEXP _WaterGAPLite_WaterUseCalcDaily(SEXP waterUseTypeSEXP, SEXP dailyUseSEXP, SEXP yearSEXP, SEXP monthSEXP, SEXP StartYearSEXP, SEXP Info_GWSEXP, SEXP Info_SWSEXP, SEXP Info_TFSEXP) {
-BEGIN_RCPP
-    Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< int >::type waterUseType(waterUseTypeSEXP);
-    Rcpp::traits::input_parameter< NumericMatrix >::type dailyUse(dailyUseSEXP);
-    Rcpp::traits::input_parameter< int >::type year(yearSEXP);
-    Rcpp::traits::input_parameter< int >::type month(monthSEXP);
-    Rcpp::traits::input_parameter< int >::type StartYear(StartYearSEXP);
-    Rcpp::traits::input_parameter< NumericMatrix >::type Info_GW(Info_GWSEXP);
-    Rcpp::traits::input_parameter< NumericMatrix >::type Info_SW(Info_SWSEXP);
-    Rcpp::traits::input_parameter< NumericMatrix >::type Info_TF(Info_TFSEXP);
-    WaterUseCalcDaily(waterUseType, dailyUse, year, month, StartYear, Info_GW, Info_SW, Info_TF);
-    return R_NilValue;
-END_RCPP
-}
 // createWaterBalance
-List createWaterBalance(DateVector timestring);
-RcppExport SEXP _WaterGAPLite_createWaterBalance(SEXP timestringSEXP) {
+List createWaterBalance(SEXP modelContext, DateVector timestring);
+RcppExport SEXP _WaterGAPLite_createWaterBalance(SEXP modelContextSEXP, SEXP timestringSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type modelContext(modelContextSEXP);
     Rcpp::traits::input_parameter< DateVector >::type timestring(timestringSEXP);
-    rcpp_result_gen = Rcpp::wrap(createWaterBalance(timestring));
-    return rcpp_result_gen;
-END_RCPP
-}
-// dailyEstimateLongwave
-double dailyEstimateLongwave(int n, int DOY, double dailyTempC, double dailyShortWave);
-RcppExport SEXP _WaterGAPLite_dailyEstimateLongwave(SEXP nSEXP, SEXP DOYSEXP, SEXP dailyTempCSEXP, SEXP dailyShortWaveSEXP) {
-BEGIN_RCPP
-    Rcpp::RObject rcpp_result_gen;
-    Rcpp::traits::input_parameter< int >::type n(nSEXP);
-    Rcpp::traits::input_parameter< int >::type DOY(DOYSEXP);
-    Rcpp::traits::input_parameter< double >::type dailyTempC(dailyTempCSEXP);
-    Rcpp::traits::input_parameter< double >::type dailyShortWave(dailyShortWaveSEXP);
-    rcpp_result_gen = Rcpp::wrap(dailyEstimateLongwave(n, DOY, dailyTempC, dailyShortWave));
+    rcpp_result_gen = Rcpp::wrap(createWaterBalance(modelContext, timestring));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -158,24 +128,6 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
-// dailySnow
-void dailySnow(int day, const NumericVector daily_prec_to_soil, NumericVector G_snow, NumericMatrix G_snowWaterEquivalent, NumericVector dailySnowMelt, NumericVector dailySnowEvapo, NumericVector thresh_elev, NumericVector dailyEffPrec, NumericVector dailySoilPET);
-RcppExport SEXP _WaterGAPLite_dailySnow(SEXP daySEXP, SEXP daily_prec_to_soilSEXP, SEXP G_snowSEXP, SEXP G_snowWaterEquivalentSEXP, SEXP dailySnowMeltSEXP, SEXP dailySnowEvapoSEXP, SEXP thresh_elevSEXP, SEXP dailyEffPrecSEXP, SEXP dailySoilPETSEXP) {
-BEGIN_RCPP
-    Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< int >::type day(daySEXP);
-    Rcpp::traits::input_parameter< const NumericVector >::type daily_prec_to_soil(daily_prec_to_soilSEXP);
-    Rcpp::traits::input_parameter< NumericVector >::type G_snow(G_snowSEXP);
-    Rcpp::traits::input_parameter< NumericMatrix >::type G_snowWaterEquivalent(G_snowWaterEquivalentSEXP);
-    Rcpp::traits::input_parameter< NumericVector >::type dailySnowMelt(dailySnowMeltSEXP);
-    Rcpp::traits::input_parameter< NumericVector >::type dailySnowEvapo(dailySnowEvapoSEXP);
-    Rcpp::traits::input_parameter< NumericVector >::type thresh_elev(thresh_elevSEXP);
-    Rcpp::traits::input_parameter< NumericVector >::type dailyEffPrec(dailyEffPrecSEXP);
-    Rcpp::traits::input_parameter< NumericVector >::type dailySoilPET(dailySoilPETSEXP);
-    dailySnow(day, daily_prec_to_soil, G_snow, G_snowWaterEquivalent, dailySnowMelt, dailySnowEvapo, thresh_elev, dailyEffPrec, dailySoilPET);
-    return R_NilValue;
-END_RCPP
-}
 // defSettings
 void defSettings(NumericVector Settings);
 RcppExport SEXP _WaterGAPLite_defSettings(SEXP SettingsSEXP) {
@@ -187,74 +139,67 @@ BEGIN_RCPP
 END_RCPP
 }
 // routing
-List routing(DateVector SimPeriod, NumericMatrix surfaceRunoff, NumericMatrix GroundwaterRunoff, NumericMatrix PETw, NumericMatrix Prec);
-RcppExport SEXP _WaterGAPLite_routing(SEXP SimPeriodSEXP, SEXP surfaceRunoffSEXP, SEXP GroundwaterRunoffSEXP, SEXP PETwSEXP, SEXP PrecSEXP) {
+List routing(SEXP modelContext, DateVector SimPeriod, NumericMatrix surfaceRunoff, NumericMatrix GroundwaterRunoff, NumericMatrix PETw, NumericMatrix Prec);
+RcppExport SEXP _WaterGAPLite_routing(SEXP modelContextSEXP, SEXP SimPeriodSEXP, SEXP surfaceRunoffSEXP, SEXP GroundwaterRunoffSEXP, SEXP PETwSEXP, SEXP PrecSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type modelContext(modelContextSEXP);
     Rcpp::traits::input_parameter< DateVector >::type SimPeriod(SimPeriodSEXP);
     Rcpp::traits::input_parameter< NumericMatrix >::type surfaceRunoff(surfaceRunoffSEXP);
     Rcpp::traits::input_parameter< NumericMatrix >::type GroundwaterRunoff(GroundwaterRunoffSEXP);
     Rcpp::traits::input_parameter< NumericMatrix >::type PETw(PETwSEXP);
     Rcpp::traits::input_parameter< NumericMatrix >::type Prec(PrecSEXP);
-    rcpp_result_gen = Rcpp::wrap(routing(SimPeriod, surfaceRunoff, GroundwaterRunoff, PETw, Prec));
+    rcpp_result_gen = Rcpp::wrap(routing(modelContext, SimPeriod, surfaceRunoff, GroundwaterRunoff, PETw, Prec));
     return rcpp_result_gen;
 END_RCPP
 }
-// CheckResType
-void CheckResType();
-RcppExport SEXP _WaterGAPLite_CheckResType() {
-BEGIN_RCPP
-    Rcpp::RNGScope rcpp_rngScope_gen;
-    CheckResType();
-    return R_NilValue;
-END_RCPP
-}
-// setLakeWetlandToMaximum
-void setLakeWetlandToMaximum(NumericVector S_locLakeStorage, NumericVector S_locWetlandStorage, NumericVector S_gloLakeStorage, NumericVector S_ResStorage, NumericVector S_gloWetlandStorage);
-RcppExport SEXP _WaterGAPLite_setLakeWetlandToMaximum(SEXP S_locLakeStorageSEXP, SEXP S_locWetlandStorageSEXP, SEXP S_gloLakeStorageSEXP, SEXP S_ResStorageSEXP, SEXP S_gloWetlandStorageSEXP) {
+// runModel
+List runModel(DateVector SimPeriod, List ListConst, NumericVector Settings, int nYears, Nullable<CharacterVector> outputVars, std::string outputTimestep);
+RcppExport SEXP _WaterGAPLite_runModel(SEXP SimPeriodSEXP, SEXP ListConstSEXP, SEXP SettingsSEXP, SEXP nYearsSEXP, SEXP outputVarsSEXP, SEXP outputTimestepSEXP) {
 BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< NumericVector >::type S_locLakeStorage(S_locLakeStorageSEXP);
-    Rcpp::traits::input_parameter< NumericVector >::type S_locWetlandStorage(S_locWetlandStorageSEXP);
-    Rcpp::traits::input_parameter< NumericVector >::type S_gloLakeStorage(S_gloLakeStorageSEXP);
-    Rcpp::traits::input_parameter< NumericVector >::type S_ResStorage(S_ResStorageSEXP);
-    Rcpp::traits::input_parameter< NumericVector >::type S_gloWetlandStorage(S_gloWetlandStorageSEXP);
-    setLakeWetlandToMaximum(S_locLakeStorage, S_locWetlandStorage, S_gloLakeStorage, S_ResStorage, S_gloWetlandStorage);
-    return R_NilValue;
+    Rcpp::traits::input_parameter< DateVector >::type SimPeriod(SimPeriodSEXP);
+    Rcpp::traits::input_parameter< List >::type ListConst(ListConstSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Settings(SettingsSEXP);
+    Rcpp::traits::input_parameter< int >::type nYears(nYearsSEXP);
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type outputVars(outputVarsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type outputTimestep(outputTimestepSEXP);
+    rcpp_result_gen = Rcpp::wrap(runModel(SimPeriod, ListConst, Settings, nYears, outputVars, outputTimestep));
+    return rcpp_result_gen;
 END_RCPP
 }
-// routingRiver
-double routingRiver(int cell, double riverVelocity, double RiverInflow, NumericVector G_riverOutflow, NumericVector S_river);
-RcppExport SEXP _WaterGAPLite_routingRiver(SEXP cellSEXP, SEXP riverVelocitySEXP, SEXP RiverInflowSEXP, SEXP G_riverOutflowSEXP, SEXP S_riverSEXP) {
+// runModelContext
+List runModelContext(SEXP modelContext, DateVector SimPeriod, int nYears);
+RcppExport SEXP _WaterGAPLite_runModelContext(SEXP modelContextSEXP, SEXP SimPeriodSEXP, SEXP nYearsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< int >::type cell(cellSEXP);
-    Rcpp::traits::input_parameter< double >::type riverVelocity(riverVelocitySEXP);
-    Rcpp::traits::input_parameter< double >::type RiverInflow(RiverInflowSEXP);
-    Rcpp::traits::input_parameter< NumericVector >::type G_riverOutflow(G_riverOutflowSEXP);
-    Rcpp::traits::input_parameter< NumericVector >::type S_river(S_riverSEXP);
-    rcpp_result_gen = Rcpp::wrap(routingRiver(cell, riverVelocity, RiverInflow, G_riverOutflow, S_river));
+    Rcpp::traits::input_parameter< SEXP >::type modelContext(modelContextSEXP);
+    Rcpp::traits::input_parameter< DateVector >::type SimPeriod(SimPeriodSEXP);
+    Rcpp::traits::input_parameter< int >::type nYears(nYearsSEXP);
+    rcpp_result_gen = Rcpp::wrap(runModelContext(modelContext, SimPeriod, nYears));
     return rcpp_result_gen;
 END_RCPP
 }
-// getRiverVelocity
-double getRiverVelocity(int Type, int cell, double inflow);
-RcppExport SEXP _WaterGAPLite_getRiverVelocity(SEXP TypeSEXP, SEXP cellSEXP, SEXP inflowSEXP) {
+// runModelBatch
+List runModelBatch(List ListConstList, NumericVector Settings, int nYears, int nThreads);
+RcppExport SEXP _WaterGAPLite_runModelBatch(SEXP ListConstListSEXP, SEXP SettingsSEXP, SEXP nYearsSEXP, SEXP nThreadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< int >::type Type(TypeSEXP);
-    Rcpp::traits::input_parameter< int >::type cell(cellSEXP);
-    Rcpp::traits::input_parameter< double >::type inflow(inflowSEXP);
-    rcpp_result_gen = Rcpp::wrap(getRiverVelocity(Type, cell, inflow));
+    Rcpp::traits::input_parameter< List >::type ListConstList(ListConstListSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type Settings(SettingsSEXP);
+    Rcpp::traits::input_parameter< int >::type nYears(nYearsSEXP);
+    Rcpp::traits::input_parameter< int >::type nThreads(nThreadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(runModelBatch(ListConstList, Settings, nYears, nThreads));
     return rcpp_result_gen;
 END_RCPP
 }
-// runModel
-List runModel(DateVector SimPeriod, List ListConst, NumericVector Settings, int nYears);
-RcppExport SEXP _WaterGAPLite_runModel(SEXP SimPeriodSEXP, SEXP ListConstSEXP, SEXP SettingsSEXP, SEXP nYearsSEXP) {
+// runModelCoupled
+List runModelCoupled(DateVector SimPeriod, List ListConst, NumericVector Settings, int nYears, Nullable<CharacterVector> outputVars, std::string outputTimestep);
+RcppExport SEXP _WaterGAPLite_runModelCoupled(SEXP SimPeriodSEXP, SEXP ListConstSEXP, SEXP SettingsSEXP, SEXP nYearsSEXP, SEXP outputVarsSEXP, SEXP outputTimestepSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -262,7 +207,9 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< List >::type ListConst(ListConstSEXP);
     Rcpp::traits::input_parameter< NumericVector >::type Settings(SettingsSEXP);
     Rcpp::traits::input_parameter< int >::type nYears(nYearsSEXP);
-    rcpp_result_gen = Rcpp::wrap(runModel(SimPeriod, ListConst, Settings, nYears));
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type outputVars(outputVarsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type outputTimestep(outputTimestepSEXP);
+    rcpp_result_gen = Rcpp::wrap(runModelCoupled(SimPeriod, ListConst, Settings, nYears, outputVars, outputTimestep));
     return rcpp_result_gen;
 END_RCPP
 }
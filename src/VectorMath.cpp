@@ -0,0 +1,12 @@
+#include "VectorMath.h"
+
+// checks the CPU once (see VectorMath.h)
+int vectorLevel(){
+#if VECTOR_KERNELS
+	static const int level = __builtin_cpu_supports("avx512f") ? 2 :
+		((__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) ? 1 : 0);
+	return(level);
+#else
+	return(0);
+#endif
+}
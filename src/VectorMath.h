@@ -0,0 +1,149 @@
+#ifndef VECTORMATH_H
+#define VECTORMATH_H
+
+#include <stdint.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+
+// vectorized daily kernels (dailyInterception(), dailyImmediateRunoff(), dailySoil(), dailySplitRunOff()):
+// the loop body of a kernel is written without branches (selects instead of if/else) and compiled a second and third time
+// for AVX2 and AVX-512, which are chosen at runtime (vectorLevel()); the original loop is used if the CPU has neither
+// (or with useSIMD = FALSE in ListConst)
+// all operations are the same as in the scalar code, except pow(), which is replaced by simdPow() (relative difference
+// to pow() below 1e-13); fluxes and storages differ from the scalar code by less than 1e-11 of the largest value of the
+// variable (single values close to 0, e.g. river storage after water abstraction, can differ more in relative terms)
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VECTOR_KERNELS 1
+#define VECTOR_INLINE inline __attribute__((always_inline))
+#define VECTOR_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define VECTOR_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define VECTOR_KERNELS 0
+#define VECTOR_INLINE inline
+#define VECTOR_TARGET_AVX2
+#define VECTOR_TARGET_AVX512
+#endif
+
+// instruction set that is used for the vectorized kernels: 0 = none (scalar code), 1 = AVX2, 2 = AVX-512
+int vectorLevel();
+
+static VECTOR_INLINE uint64_t asBits(double x){
+	uint64_t b;
+	memcpy(&b, &x, sizeof(b));
+	return(b);
+}
+
+static VECTOR_INLINE double asDouble(uint64_t b){
+	double x;
+	memcpy(&x, &b, sizeof(x));
+	return(x);
+}
+
+// c ? a : b with a mask instead of a branch
+// (with -ftrapping-math, the default, gcc does not vectorize loops in which a select needs arithmetic in one branch)
+static VECTOR_INLINE double simdSelect(bool c, double a, double b){
+	const uint64_t mask = -(uint64_t) c;
+	return(asDouble((asBits(a) & mask) | (asBits(b) & ~mask)));
+}
+
+// true if pow(x, y) can be calculated with simdPow() (x is 0 or a normal positive number)
+static VECTOR_INLINE bool simdPowValid(double x){
+	return((x == 0.) | (__builtin_isgreaterequal(x, DBL_MIN) & __builtin_islessequal(x, DBL_MAX)));
+}
+
+// log(x) for normal positive x (same algorithm as fdlibm, without special cases)
+static VECTOR_INLINE double simdLog(double x){
+	const double ln2_hi = 6.93147180369123816490e-01;
+	const double ln2_lo = 1.90821492927058770002e-10;
+	const double Lg1 = 6.666666666666735130e-01;
+	const double Lg2 = 3.999999999940941908e-01;
+	const double Lg3 = 2.857142874366239149e-01;
+	const double Lg4 = 2.222219843214978396e-01;
+	const double Lg5 = 1.818357216161805012e-01;
+	const double Lg6 = 1.531383769920937332e-01;
+	const double Lg7 = 1.479819860511658591e-01;
+
+	// x = 2^k * (1+f) with sqrt(2)/2 <= 1+f < sqrt(2)
+	const uint64_t bits = asBits(x);
+	const uint64_t hx = (bits >> 32) + (0x3ff00000 - 0x3fe6a09e);
+	const double k = asDouble(0x4330000000000000ULL | (hx >> 20)) - (4503599627370496.0 + 1023.0); // exponent without int -> double conversion
+	const double f = asDouble((((hx & 0x000fffff) + 0x3fe6a09e) << 32) | (bits & 0xffffffffULL)) - 1.0;
+
+	const double hfsq = 0.5 * f * f;
+	const double s = f / (2.0 + f);
+	const double z = s * s;
+	const double w = z * z;
+	const double R = z * (Lg1 + w * (Lg3 + w * (Lg5 + w * Lg7))) + w * (Lg2 + w * (Lg4 + w * Lg6));
+	return(k * ln2_hi - ((hfsq - (s * (hfsq + R) + k * ln2_lo)) - f));
+}
+
+// exp(t) (same algorithm as fdlibm), results below DBL_MIN are 0
+static VECTOR_INLINE double simdExp(double t){
+	const double inv_ln2 = 1.44269504088896338700e+00;
+	const double ln2_hi = 6.93147180369123816490e-01;
+	const double ln2_lo = 1.90821492927058770002e-10;
+	const double P1 = 1.66666666666666019037e-01;
+	const double P2 = -2.77777777770155933842e-03;
+	const double P3 = 6.61375632143793436117e-05;
+	const double P4 = -1.65339022054652515390e-06;
+	const double P5 = 4.13813679705723846039e-08;
+	const double shift = 6755399441055744.0; // 1.5 * 2^52: rounds to integer, which is in the lower bits then
+
+	// t = k*ln2 + r, |r| <= ln2/2
+	double kd = t * inv_ln2 + shift;
+	const uint64_t kb = asBits(kd);
+	kd -= shift;
+	const double hi = t - kd * ln2_hi;
+	const double lo = kd * ln2_lo;
+	const double r = hi - lo;
+	const double c2 = r * r;
+	const double c = r - c2 * (P1 + c2 * (P2 + c2 * (P3 + c2 * (P4 + c2 * P5))));
+	const double y = 1.0 - ((lo - (r * c) / (2.0 - c)) - hi);
+	double res = y * asDouble((kb + 1023) << 52);
+
+	// out of range: 0 or Inf
+	return(simdSelect(__builtin_isgreater(t, 709.0), HUGE_VAL, simdSelect(__builtin_isless(t, -708.0), 0., res)));
+}
+
+// pow(x, y) for simdPowValid(x) and finite y (otherwise the result is undefined)
+static VECTOR_INLINE double simdPow(double x, double y){
+	const double zero = simdSelect(y > 0., 0., simdSelect(y == 0., 1., HUGE_VAL)); // pow(0, y)
+	return(simdSelect(x == 0., zero, simdExp(y * simdLog(x))));
+}
+
+// runs kernel(i) for i = 0 ... n-1 with the instruction set of level (see vectorLevel())
+// kernel has to be written without branches and without dependencies between cells
+template <class Kernel>
+VECTOR_TARGET_AVX2 void runVectorKernelAvx2(const Kernel& kernel, int n){
+	Kernel k = kernel; // local copy, otherwise the pointers are loaded again after every store
+#ifdef _OPENMP
+	#pragma omp simd
+#endif
+	for (int i = 0; i < n; i++){
+		k(i);
+	}
+}
+
+template <class Kernel>
+VECTOR_TARGET_AVX512 void runVectorKernelAvx512(const Kernel& kernel, int n){
+	Kernel k = kernel; // local copy, otherwise the pointers are loaded again after every store
+#ifdef _OPENMP
+	#pragma omp simd
+#endif
+	for (int i = 0; i < n; i++){
+		k(i);
+	}
+}
+
+template <class Kernel>
+void runVectorKernel(int level, const Kernel& kernel, int n){
+	if (level >= 2) {
+		runVectorKernelAvx512(kernel, n);
+	} else {
+		runVectorKernelAvx2(kernel, n);
+	}
+}
+
+#endif
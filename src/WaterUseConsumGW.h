@@ -1,6 +1,6 @@
 #ifndef WATERUSECONSUMEGW_H
 #define WATERUSECONSUMEGW_H
 
-double WaterUseConsumGW(int cell, NumericVector GroundwaterStorage, const NumericMatrix dailyUse);
+double WaterUseConsumGW(ModelContext& ctx, int cell, NumericVector& GroundwaterStorage, const WaterUseDay& dailyUse);
  
 #endif
\ No newline at end of file
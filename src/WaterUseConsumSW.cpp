@@ -1,20 +1,31 @@
 #include <Rcpp.h>
 #include <math.h>
+#include <algorithm>
 #include "initModel.h"
 #include "WaterUseConsumSW.h"
+#include "initializeModel.h"
+#include "routing.h"
 
 
 
 //whin geht return flow. d.h. wenn water use hat negatives VZ
 // geht immer in river!
 
-double AbstractFromCell(int cell, double remainingUse, NumericVector G_actualUse,
-						NumericVector S_river, NumericVector S_ResStorage, NumericVector S_gloLakeStorage,
-						NumericVector S_locLakeStorage);
+double AbstractFromCell(ModelContext& ctx, int cell, double remainingUse, NumericVector& G_actualUse,
+						NumericVector& S_river, NumericVector& S_ResStorage, NumericVector& S_gloLakeStorage,
+						NumericVector& S_locLakeStorage);
+void SpatialAllocationCell(ModelContext& ctx, int cell, double remainingUse, NumericVector& G_totalUnsatisfiedUse,
+						   NumericVector& S_river, NumericVector& S_ResStorage, NumericVector& S_gloLakeStorage, 
+						   NumericVector& S_locLakeStorage, NumericVector& G_actualUse);
+void SpatialAllocationNetwork(ModelContext& ctx, NumericVector& G_totalUnsatisfiedUse,
+						   NumericVector& S_river, NumericVector& S_ResStorage, NumericVector& S_gloLakeStorage, 
+						   NumericVector& S_locLakeStorage, NumericVector& G_actualUse);
 
 //' @title SubtractWaterConsumSW
 //' @description function that distributes water use spatial and/or temporal, needs helper function AbstractFromCell for water use abstraction
-//' @param WaterUseAllocationType 0 (spatial and temporal distribution), 1 (spatial distribution), 2 (temporal distribution) 
+//' @param ctx ModelContext of the model
+//' @param WaterUseAllocationType 0 (spatial and temporal distribution), 1 (spatial distribution), 2 (temporal distribution),
+//' 3 (spatial and temporal distribution, spatial along the river network: SpatialAllocationNetwork())
 //' @param dailyUse Matrix with two rows that gives water use for actual day in mm*km²/day (first = GW, second=SW+TF), note that all days in one month in one year have same values
 //' @param G_totalUnsatisfiedUse unsatisfied uses that are potentially spatial and/or temporal distributed
 //' @param S_river river storage to satisfy uses (1)
@@ -23,18 +34,18 @@ double AbstractFromCell(int cell, double remainingUse, NumericVector G_actualUse
 //' @param S_locLakeStorage local lake storage to satisfy uses (4)
 //' @param G_actualUse actual use in cell in mm*km²/day
 //' @export
-void SubtractWaterConsumSW(int WaterUseAllocationType, NumericMatrix dailyUse, NumericVector G_totalUnsatisfiedUse,
-						   NumericVector S_river, NumericVector S_ResStorage, NumericVector S_gloLakeStorage, 
-						   NumericVector S_locLakeStorage, NumericVector G_actualUse) {
+void SubtractWaterConsumSW(ModelContext& ctx, int WaterUseAllocationType, const WaterUseDay& dailyUse, NumericVector& G_totalUnsatisfiedUse,
+						   NumericVector& S_river, NumericVector& S_ResStorage, NumericVector& S_gloLakeStorage, 
+						   NumericVector& S_locLakeStorage, NumericVector& G_actualUse) {
 	
 	
 	double dailyUseSW=0;
 	double totalDesiredUse=0;
 	double remainingUse=0;
 	
-	for (int cell = 0; cell < array_size; cell++) {
+	for (int cell = 0; cell < ctx.array_size; cell++) {
 
-		dailyUseSW= dailyUse.at(1,cell);	//  mm*km²/day
+		dailyUseSW= dailyUse(1,cell);	//  mm*km²/day
 		
 		
 		// for TEMPORAL distribution
@@ -49,7 +60,7 @@ void SubtractWaterConsumSW(int WaterUseAllocationType, NumericMatrix dailyUse, N
 		// 'remainingUse' contains always the amount of water that has not been satisfied
 		remainingUse = totalDesiredUse;
 		
-		remainingUse = AbstractFromCell(cell, remainingUse, G_actualUse,
+		remainingUse = AbstractFromCell(ctx, cell, remainingUse, G_actualUse,
 										S_river, S_ResStorage, S_gloLakeStorage,
 										S_locLakeStorage);
 
@@ -65,73 +76,209 @@ void SubtractWaterConsumSW(int WaterUseAllocationType, NumericMatrix dailyUse, N
 	
 	// now it is looked up in the neighbouringcells (to account for inaccuracy in modeling) and the next 20 downstream cells to satisfy demand
 	// for SPATIALLY distribution
-	if (WaterUseAllocationType != 2) {
+	if (WaterUseAllocationType == 3) {
 		
-		short i;
-		int index;
-		int secondCell;
-		int downstreamCell;
-		double storageSum;
-		double totalNeighbourStorage;
-		double totalRemainingUse;
+		SpatialAllocationNetwork(ctx, G_totalUnsatisfiedUse, S_river, S_ResStorage, S_gloLakeStorage, S_locLakeStorage, G_actualUse);
 		
-
-		for (int cell = 0; cell < array_size; cell++) {
-
-			totalRemainingUse = G_totalUnsatisfiedUse[cell]; // for new Use allocation (M.Hunger 2/2006)
-			totalNeighbourStorage = 0;
-			secondCell = -1;
-			
-			//finding neighbouring station from cell (within basin) with largest storage volume 
-			for (i = 0; i < 8; i++) {
-				index = (NeighbouringCells(i, cell) -1) ;
-				if (index == 0){
-					storageSum = 0; //than no neighbouring cell for this position
-				} else {
-					storageSum = S_river[index]
-								+ S_locLakeStorage[index]
-								+ S_gloLakeStorage[index]
-								+ S_ResStorage[index];
-				} 
-				
-				if (storageSum > totalNeighbourStorage) {
-					totalNeighbourStorage = storageSum;
-					secondCell = index;
-				}
-			}
-			
-			//calculate abstraction from neighbouring cell first 
-			if (secondCell >= 0) {
-				totalRemainingUse = AbstractFromCell(cell, remainingUse, G_actualUse,
-										S_river, S_ResStorage, S_gloLakeStorage,
-										S_locLakeStorage);
-			}
-			
-			// if water demand is still not satisfied, abstract water from next 20 downstream stations
-			i = 0;
-			downstreamCell=outflowOrder[cell];
-			while (totalRemainingUse > 0 && i < reservoir_dsc && downstreamCell >= 0){
-				
-				if (downstreamCell != secondCell){
-					totalRemainingUse = AbstractFromCell(cell, remainingUse, G_actualUse,
-										S_river, S_ResStorage, S_gloLakeStorage,
-										S_locLakeStorage);
-				}
-				
-				downstreamCell = outflowOrder[downstreamCell-1];
-				i++;
+	} else if (WaterUseAllocationType != 2) {
+		
+		// cells of one colour do not depend on each other (initWaterUseColours()), colours are simulated in order
+		// -> same results as cell by cell and independent of the number of threads
+#ifdef _OPENMP
+		const int nThreads = ctx.nThreadsRouting;
+#endif
+		
+		for (int c = 0; c < ctx.nWaterUseColours; c++) {
+#ifdef _OPENMP
+			#pragma omp parallel for schedule(static) num_threads(nThreads) if ((nThreads > 1) && (ctx.waterUseColourStart[c+1] - ctx.waterUseColourStart[c] >= ctx.minCellsParallel))
+#endif
+			for (int k = ctx.waterUseColourStart[c]; k < ctx.waterUseColourStart[c+1]; k++) {
+				SpatialAllocationCell(ctx, ctx.waterUseColourCells[k], remainingUse, G_totalUnsatisfiedUse,
+										S_river, S_ResStorage, S_gloLakeStorage, S_locLakeStorage, G_actualUse);
 			}
-			
-			G_totalUnsatisfiedUse[cell] = totalRemainingUse; //iis set to 0 for 01.01.XXXX
 		}
 	}
 		
 		
 } 
 
+// sum of the surface water storages of every cell that are used for water use (see AbstractFromCell()) [mm*km²]
+NumericVector waterUseStorage(ModelContext& ctx){
+	NumericVector storage(ctx.array_size);
+	for (int cell = 0; cell < ctx.array_size; cell++) {
+		storage[cell] = ctx.S_river[cell] + ctx.S_ResStorage[cell] + ctx.S_gloLakeStorage[cell] + ctx.S_locLakeStorage[cell];
+	}
+	return(storage);
+}
+
+//' @title subtractWaterUseSW
+//' @description abstracts the surface water use of one day from the storages of a model with the water use allocation of its settings (see SubtractWaterConsumSW()),
+//' e.g. after runModelContext() with the states at the end of the simulation period to check the allocation
+//' @param modelContext model created with initModelContext()
+//' @param useSW surface water use of every cell in mm*km²/day
+//' @return list with the sum of surface water storages (river, reservoir, global and local lake) of every cell before and after the abstraction (mm*km²),
+//' unsatisfied use of the earlier days, actual use and unsatisfied use of every cell (mm*km²/day)
+//' @export
+// [[Rcpp::export]]
+List subtractWaterUseSW(SEXP modelContext, NumericVector useSW){
+	
+	ModelContext& ctx = getModelContext(modelContext);
+	if (useSW.length() != ctx.array_size) {
+		stop("useSW needs one value for each of the %i cells", ctx.array_size);
+	}
+	CheckResType(ctx);
+	initDownstreamPaths(ctx); // downstream cells of reservoirs (after CheckResType())
+	
+	vector<double> dailyUse(2 * (size_t) ctx.array_size, 0.); // layout of WaterUseDay: GW and SW of a cell next to each other
+	for (int cell = 0; cell < ctx.array_size; cell++) {
+		dailyUse[2 * (size_t) cell + 1] = useSW[cell];
+	}
+	
+	NumericVector StorageBefore = waterUseStorage(ctx);
+	NumericVector UnsatisfiedUseBefore = clone(ctx.G_totalUnsatisfiedUse);
+	ctx.G_actualUse.fill(0);
+	SubtractWaterConsumSW(ctx, ctx.WaterUseAllocationType, WaterUseDay(dailyUse.data(), ctx.array_size), ctx.G_totalUnsatisfiedUse,
+						   ctx.S_river, ctx.S_ResStorage, ctx.S_gloLakeStorage, 
+						   ctx.S_locLakeStorage, ctx.G_actualUse);
+	
+	return(List::create(Named("StorageBefore") = StorageBefore, Named("StorageAfter") = waterUseStorage(ctx),
+						Named("UnsatisfiedUseBefore") = UnsatisfiedUseBefore, Named("ActualUse") = clone(ctx.G_actualUse),
+						Named("UnsatisfiedUse") = clone(ctx.G_totalUnsatisfiedUse)));
+}
+
+
+// spatial distribution of the unsatisfied use of one cell (second part of SubtractWaterConsumSW())
+// only storages of cell itself are changed, storages of the neighbouring cells are read
+// (AbstractFromCell() is always called with cell itself, not with secondCell or the downstream cells, as in the original code);
+// the parallel simulation by colours (initWaterUseColours()) relies on this: if water is ever taken from the neighbouring or
+// downstream cells here, cells of one colour are no longer independent
+void SpatialAllocationCell(ModelContext& ctx, int cell, double remainingUse, NumericVector& G_totalUnsatisfiedUse,
+						   NumericVector& S_river, NumericVector& S_ResStorage, NumericVector& S_gloLakeStorage, 
+						   NumericVector& S_locLakeStorage, NumericVector& G_actualUse) {
+	
+	int index;
+	int secondCell;
+	int downstreamCell;
+	double storageSum;
+	double totalNeighbourStorage;
+	double totalRemainingUse;
+	
+	totalRemainingUse = G_totalUnsatisfiedUse[cell]; // for new Use allocation (M.Hunger 2/2006)
+	totalNeighbourStorage = 0;
+	secondCell = -1;
+	
+	//finding neighbouring station from cell (within basin) with largest storage volume 
+	const int* neighbours = &ctx.neighbourCells[8 * (size_t) cell];
+	for (int i = 0; i < 8; i++) {
+		index = neighbours[i];
+		if (index < 0){
+			storageSum = 0; //than no neighbouring cell for this position
+		} else {
+			storageSum = S_river[index]
+						+ S_locLakeStorage[index]
+						+ S_gloLakeStorage[index]
+						+ S_ResStorage[index];
+		} 
+		
+		if (storageSum > totalNeighbourStorage) {
+			totalNeighbourStorage = storageSum;
+			secondCell = index;
+		}
+	}
+	
+	//calculate abstraction from neighbouring cell first 
+	if (secondCell >= 0) {
+		totalRemainingUse = AbstractFromCell(ctx, cell, remainingUse, G_actualUse,
+								S_river, S_ResStorage, S_gloLakeStorage,
+								S_locLakeStorage);
+	}
+	
+	// if water demand is still not satisfied, abstract water from next 20 downstream stations (initDownstreamPaths())
+	for (int k = ctx.downstreamStart[cell]; totalRemainingUse > 0 && k < ctx.downstreamStart[cell+1]; k++){
+		
+		downstreamCell = ctx.downstreamCells[k] + 1; // as in outflowOrder (1 = first cell)
+		if (downstreamCell != secondCell){
+			totalRemainingUse = AbstractFromCell(ctx, cell, remainingUse, G_actualUse,
+								S_river, S_ResStorage, S_gloLakeStorage,
+								S_locLakeStorage);
+		}
+	}
+	
+	G_totalUnsatisfiedUse[cell] = totalRemainingUse; //iis set to 0 for 01.01.XXXX
+}
+
+
+// spatial distribution along the river network (WaterUseAllocationType 3): the unsatisfied use of every cell is passed on to its
+// next reservoir_dsc downstream cells in one sweep from upstream to downstream (order of the routing schedule) instead of
+// searching neighbouring and downstream cells for every cell; a cell satisfies the deficits that reach it from its own storages
+// (all deficits in the cell by the same fraction), the rest moves on to the next cell
+// deficits of a cell are summed up per number of cells they have passed, so a cell only has reservoir_dsc values
+// the water taken from a cell for the deficits is added to G_actualUse of the cells with the demand (as in SpatialAllocationCell()),
+// not to G_actualUse of the cell where it was taken
+void SpatialAllocationNetwork(ModelContext& ctx, NumericVector& G_totalUnsatisfiedUse,
+						   NumericVector& S_river, NumericVector& S_ResStorage, NumericVector& S_gloLakeStorage, 
+						   NumericVector& S_locLakeStorage, NumericVector& G_actualUse) {
+	
+	const int horizon = ctx.reservoir_dsc;
+	double* deficit = ctx.waterUseDeficit.data(); // 0 before and after the sweep
+	double* keep = ctx.waterUseKeep.data();
+	
+	for (int k = 0; k < ctx.array_size; k++) {
+		const int cell = ctx.routeCells[k];
+		double* cellDeficit = deficit + (size_t) cell * horizon;
+		
+		double totalDeficit = 0.;
+		for (int h = 0; h < horizon; h++) {
+			totalDeficit += cellDeficit[h];
+		}
+		keep[cell] = 1.;
+		if (totalDeficit > 0) {
+			const double actualUse = G_actualUse[cell]; // is booked for the demanding cells below
+			keep[cell] = AbstractFromCell(ctx, cell, totalDeficit, G_actualUse,
+										S_river, S_ResStorage, S_gloLakeStorage,
+										S_locLakeStorage) / totalDeficit;
+			G_actualUse[cell] = actualUse;
+		}
+		
+		// own unsatisfied use and the rest of the deficits go to the downstream cell (if it comes later in the routing schedule)
+		const int downstreamCell = ctx.outflowOrder[cell] - 1;
+		if ((downstreamCell >= 0) && (downstreamCell < ctx.array_size) && (ctx.routePosition[downstreamCell] > k)) {
+			double* downstreamDeficit = deficit + (size_t) downstreamCell * horizon;
+			if (G_totalUnsatisfiedUse[cell] > 0) {
+				downstreamDeficit[0] += G_totalUnsatisfiedUse[cell];
+			}
+			for (int h = 0; h + 1 < horizon; h++) {
+				downstreamDeficit[h + 1] += cellDeficit[h] * keep[cell];
+			}
+		}
+		fill(cellDeficit, cellDeficit + horizon, 0.);
+	}
+	
+	// unsatisfied use of a cell is what is left after the downstream cells that it reached (initDownstreamPaths()),
+	// the rest was taken from these cells and is actual use of the cell
+	for (int cell = 0; cell < ctx.array_size; cell++) {
+		if (G_totalUnsatisfiedUse[cell] <= 0) {
+			continue;
+		}
+		double totalRemainingUse = G_totalUnsatisfiedUse[cell];
+		int position = ctx.routePosition[cell];
+		for (int k = ctx.downstreamStart[cell]; k < ctx.downstreamStart[cell+1]; k++) {
+			const int downstreamCell = ctx.downstreamCells[k];
+			if (ctx.routePosition[downstreamCell] <= position) {
+				break; // was not passed on in the sweep
+			}
+			totalRemainingUse *= keep[downstreamCell];
+			position = ctx.routePosition[downstreamCell];
+		}
+		G_actualUse[cell] += G_totalUnsatisfiedUse[cell] - totalRemainingUse;
+		G_totalUnsatisfiedUse[cell] = totalRemainingUse; //iis set to 0 for 01.01.XXXX
+	}
+}
+
 
 //' @title AbstractFromCell
 //' @description function that abstracts water use from storages 
+//' @param ctx ModelContext of the model
 //' @param cell cell in basin that is used for abstraction
 //' @param remainingUse remainingUse of cell that needs to be satisfied with storages
 //' @param G_actualUse actual use in cell in mm*km²/day
@@ -141,11 +288,11 @@ void SubtractWaterConsumSW(int WaterUseAllocationType, NumericMatrix dailyUse, N
 //' @param S_locLakeStorage local lake storage to satisfy uses (4)
 //' @return remainingUse after intention to satisfy uses with water storages mm
 //' @export
-double AbstractFromCell(int cell, double remainingUse, NumericVector G_actualUse,
-						NumericVector S_river, NumericVector S_ResStorage, NumericVector S_gloLakeStorage,
-						NumericVector S_locLakeStorage) {
+double AbstractFromCell(ModelContext& ctx, int cell, double remainingUse, NumericVector& G_actualUse,
+						NumericVector& S_river, NumericVector& S_ResStorage, NumericVector& S_gloLakeStorage,
+						NumericVector& S_locLakeStorage) {
 	
-	int StartVal = remainingUse;
+	const double StartVal = remainingUse; // not truncated, so the actual use is the water taken from the storages
 	
 	// first step: water is taken out of the river (or returned to river!)
 	if (remainingUse < S_river[cell]) {
@@ -159,16 +306,16 @@ double AbstractFromCell(int cell, double remainingUse, NumericVector G_actualUse
 	
 	// second step: take water out of reservoirs!
 	if (remainingUse > 0) {
-		if ((G_RESAREA[cell] > 0) && (S_ResStorage[cell] > (G_STORAGE_CAPACITY[cell] * 0.1))) {
+		if ((ctx.par.wb.G_RESAREA[cell] > 0) && (S_ResStorage[cell] > (ctx.par.wb.G_STORAGE_CAPACITY[cell] * 0.1))) {
 			// storage volume of the reservoir has to be more than 10% of capacity
 			// otherwise no water is taken out of the reservoir
 			// do not allow water use below the 10% level!
-			if (remainingUse < (S_ResStorage[cell] - (G_STORAGE_CAPACITY[cell] * 0.1))) {
+			if (remainingUse < (S_ResStorage[cell] - (ctx.par.wb.G_STORAGE_CAPACITY[cell] * 0.1))) {
 				S_ResStorage[cell] -= remainingUse;
 				remainingUse = 0;
 			} else {
-				remainingUse -= (S_ResStorage[cell] - (G_STORAGE_CAPACITY[cell] * 0.1));
-				S_ResStorage[cell] = G_STORAGE_CAPACITY[cell] * 0.1;
+				remainingUse -= (S_ResStorage[cell] - (ctx.par.wb.G_STORAGE_CAPACITY[cell] * 0.1));
+				S_ResStorage[cell] = ctx.par.wb.G_STORAGE_CAPACITY[cell] * 0.1;
 			}
 		}
 	}
@@ -176,7 +323,7 @@ double AbstractFromCell(int cell, double remainingUse, NumericVector G_actualUse
 	
 	// third step: take water from global lakes
 	if (remainingUse > 0) {
-		if (((G_LAKAREA[cell]) > 0) && (S_gloLakeStorage[cell] > 0)) {
+		if (((ctx.par.wb.G_LAKAREA[cell]) > 0) && (S_gloLakeStorage[cell] > 0)) {
 			// water level of the lake has to be above 0 m
 			// otherwise no water is taken out of the global lake
 			if (remainingUse < S_gloLakeStorage[cell]) {
@@ -191,7 +338,7 @@ double AbstractFromCell(int cell, double remainingUse, NumericVector G_actualUse
 
 	// fourth step: take water from local lakes
 	if (remainingUse > 0) {
-		if ((G_LOCLAK[cell] > 0)	&& (S_locLakeStorage[cell] > 0)) {
+		if ((ctx.par.wb.G_LOCLAK[cell] > 0)	&& (S_locLakeStorage[cell] > 0)) {
 			if (remainingUse < S_locLakeStorage[cell]) {
 				S_locLakeStorage[cell] -= remainingUse;
 				remainingUse = 0;
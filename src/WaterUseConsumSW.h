@@ -1,8 +1,8 @@
 #ifndef WATERUSECONSUMESW_H
 #define WATERUSECONSUMESW_H
 
-void SubtractWaterConsumSW(int WaterUseAllocationType, NumericMatrix dailyUse, NumericVector G_totalUnsatisfiedUse,
-						   NumericVector S_river, NumericVector S_ResStorage, NumericVector S_gloLakeStorage, 
-						   NumericVector S_locLakeStorage, NumericVector G_actualUse);
+void SubtractWaterConsumSW(ModelContext& ctx, int WaterUseAllocationType, const WaterUseDay& dailyUse, NumericVector& G_totalUnsatisfiedUse,
+						   NumericVector& S_river, NumericVector& S_ResStorage, NumericVector& S_gloLakeStorage, 
+						   NumericVector& S_locLakeStorage, NumericVector& G_actualUse);
  
 #endif
\ No newline at end of file
@@ -4,112 +4,135 @@
 #include "initModel.h"
 #include "WaterUsePrepareRoutine.h"
 
-//' @title WaterUseCalcMeanDemandDaily
-//' @description Prepare infromation for reservoir (calculate yearly mean demand of cell itself and next 20 downstream cells)
-//' @param year year of simulation period as integer
-//' @param GapYearType Info from Setting wheter 29.02 is simulated (0) or not (1)
-//' @return G_mean_demand as numericVector for the sepcified year in [mm*km²/day]
-//' @export
-// [[Rcpp::export]]
-NumericVector WaterUseCalcMeanDemandDaily(int year, int GapYearType){
+//' @title WaterUseInitMeanDemand
+//' @description Prepare infromation for reservoir (yearly mean demand of cell itself and next 20 downstream cells), does not change with the year
+//' so it is calculated once before the routing (needs the downstream paths of initDownstreamPaths())
+//' @param ctx ModelContext of the model
+void WaterUseInitMeanDemand(ModelContext& ctx){
 	// info is used in reservoir
-	NumericVector G_mean_demand(array_size); //longterm water demand of cell itself
+	ctx.meanDemandDownstream.assign(ctx.array_size, 0.); //longterm water demand of cell itself (no R vector, so it can be used in threads)
+	ctx.meanDemandYear = -1;
 	
 	//calculate MEAN demand of downstream area
-	for (int cell = 0; cell < array_size; cell++){
-		
-		G_mean_demand[cell] = YearlyMeanDemand[cell];
+	for (int cell = 0; cell < ctx.array_size; cell++){
 		
-		int i=0; 
-		int downstreamCell=outflowOrder[cell];
+		ctx.meanDemandDownstream[cell] = ctx.YearlyMeanDemand[cell];
 		
-		while (i < reservoir_dsc && downstreamCell > 0 && downstreamCell < array_size && G_RESAREA[downstreamCell-1] == 0) {
+		for (int k = ctx.downstreamStart[cell]; k < ctx.downstreamReservoirEnd[cell]; k++) {
 			//suggestion Jenny: only consider positive values here
-			G_mean_demand[cell] += YearlyMeanDemand[downstreamCell-1] * G_ALLOC_COEFF(i++, cell);
-			// next downstream cell
-			downstreamCell = outflowOrder[downstreamCell-1];
+			ctx.meanDemandDownstream[cell] += ctx.YearlyMeanDemand[ctx.downstreamCells[k]] * ctx.downstreamCoeff[k];
 		}
 	}
+}
+
+//' @title WaterUseCalcMeanDemandDaily
+//' @description mean demand of cell itself and next 20 downstream cells (WaterUseInitMeanDemand()) per day of the specified year
+//' @param ctx ModelContext of the model
+//' @param year year of simulation period as integer
+//' @param GapYearType Info from Setting wheter 29.02 is simulated (0) or not (1)
+//' @return G_mean_demand as vector for the sepcified year in [mm*km²/day]
+vector<double> WaterUseCalcMeanDemandDaily(ModelContext& ctx, int year, int GapYearType){
+	vector<double> G_mean_demand(ctx.array_size);
 	
 	//unit changing from m³/yr to mm*km²/day (to m³/s) --> /= 31536000.
-	for (int cell = 0; cell < array_size; cell++){
+	for (int cell = 0; cell < ctx.array_size; cell++){
 		if (GapYearType == 1) { //avoid somulation of the 29.02 to compare modelling result to WG3
-			G_mean_demand[cell] = G_mean_demand[cell] / 1000. / 365.; //[mm*km²/day]
+			G_mean_demand[cell] = ctx.meanDemandDownstream[cell] / 1000. / 365.; //[mm*km²/day]
 		} else {
-			G_mean_demand[cell] = G_mean_demand[cell] / 1000. / numberOfDaysInYear(year); //[mm*km²/day]
+			G_mean_demand[cell] = ctx.meanDemandDownstream[cell] / 1000. / numberOfDaysInYear(year); //[mm*km²/day]
 		}
 	}
 	
 	return(G_mean_demand);
 }
 
-
-//' @title WaterUseCalcDaily
-//' @description calculates daily water use for groundwater and surface water (note that GapYearType needs to be included in function input)
-//' @param waterUseType 0 (no water use), 1 (only water use without Transport to cities) or 2 (only water use with Transport to cities)
-//' @param dailyUse Matrix with two rows that gives water use for actual day in mm*km²/day (first = GW, second=SW+TF), note that all days in one month in one year have same values
+//' @title WaterUseMeanDemandDaily
+//' @description WaterUseCalcMeanDemandDaily() of the year, only calculated again if the year changes
+//' @param ctx ModelContext of the model
 //' @param year year of simulation period as integer
-//' @param month month of simulation period as integer
-//' @param StartYear information to get the right column from read water use information
-//' @param Info_GW read water use information from groundwater
-//' @param Info_SW read water use information from surface water
-//' @param Info_TF read water use information for transport to cities
-//' @export
-// [[Rcpp::export]]
-void WaterUseCalcDaily(int waterUseType, NumericMatrix dailyUse, int year, int month, int StartYear, 
-						NumericMatrix Info_GW, NumericMatrix Info_SW, NumericMatrix Info_TF){
-	
-	if (waterUseType == 0) { // No waterUse, matrices were initialized to 0 and should not change
-		return;
+//' @return G_mean_demand for the sepcified year in [mm*km²/day] (valid until the next call)
+const vector<double>& WaterUseMeanDemandDaily(ModelContext& ctx, int year){
+	if (year != ctx.meanDemandYear) {
+		ctx.meanDemandDaily = WaterUseCalcMeanDemandDaily(ctx, year, ctx.GapYearType);
+		ctx.meanDemandYear = year;
 	}
+	return(ctx.meanDemandDaily);
+}
+
+
+//' @title WaterUseInitSchedule
+//' @description calculates daily water use for groundwater and surface water of every month of the simulation period (initSimPeriod()),
+//' note that all days in one month in one year have same values, so every day only needs the slice of its month (ctx.waterUseSchedule.day(year, month))
+//' Info_GW and Info_SW (monthly data) start by the first year of the simulation period and January, Info_TF (annual data) by the first year
+//' @param ctx ModelContext of the model (uses waterUseType: 0 (no water use), 1 (only water use without Transport to cities) or 2 (only water use with Transport to cities))
+void WaterUseInitSchedule(ModelContext& ctx){
 	
-	NumericVector GW_day (array_size);
-	NumericVector SW_day (array_size);
-	NumericVector TF_day (array_size);	
+	WaterUseSchedule& schedule = ctx.waterUseSchedule;
+	schedule.nCells = ctx.array_size;
+	schedule.firstMonth = 0;
 	
+	if ((ctx.waterUseType == 0) || (ctx.ndays == 0)) { // No waterUse, one slice with 0 for all months
+		schedule.table.assign(2 * (size_t) ctx.array_size, 0.);
+		schedule.monthStride = 0;
+		ctx.dailyUse = schedule.day(0, 1);
+		return;
+	}
+	if ((ctx.waterUseType != 1) && (ctx.waterUseType != 2)) {
+		stop("Error: WaterUseType should be 0, 1 or 2."); // It was already checked, should not happen
+	}
 	
 	//Note that with Lists is more flexible because SimPeriod can change and it still can be calculated withput the need of reading everythin in again
-	int index = 12 * (year - StartYear) + month - 1; //Matrix for SW and GW starts by StartYear and January (monthly Data)
-	int indexTF = year - StartYear; //Matrix for TF starts by StartYear (annual data)
-
-	GW_day = Info_GW(index, _ );
-	SW_day = Info_SW(index, _ );
-	TF_day = Info_TF(indexTF, _ );
-	
-	int nYears = numberOfDaysInYear(year);
-	int nMonths = numberOfDaysInMonth(month, year);
+	const int StartYear = ctx.SimYear[0];
+	int lastMonth = 0;
+	schedule.firstMonth = 12 * ctx.SimYear[0] + ctx.SimMonth[0] - 1;
+	for (int time = 0; time < ctx.ndays; time++){
+		schedule.firstMonth = min(schedule.firstMonth, 12 * ctx.SimYear[time] + ctx.SimMonth[time] - 1);
+		lastMonth = max(lastMonth, 12 * ctx.SimYear[time] + ctx.SimMonth[time] - 1);
+	}
+	const int nScheduleMonths = lastMonth - schedule.firstMonth + 1;
 	
-	if (GapYearType == 1) {
-		nYears = 365;
-		if (month == 2){ 
-			nMonths = 28; 
-		}
+	const NumericMatrix& Info_GW = ctx.Info_GW;
+	const NumericMatrix& Info_SW = ctx.Info_SW;
+	const NumericMatrix& Info_TF = ctx.Info_TF;
+	if ((lastMonth - 12 * StartYear >= min(Info_GW.nrow(), Info_SW.nrow())) || (min(Info_GW.ncol(), Info_SW.ncol()) < ctx.array_size) ||
+		((ctx.waterUseType == 2) && ((lastMonth / 12 - StartYear >= Info_TF.nrow()) || (Info_TF.ncol() < ctx.array_size)))) {
+		stop("Error: Info_GW, Info_SW or Info_TF do not cover the simulation period.");
 	}
+	
+	schedule.monthStride = 2 * (size_t) ctx.array_size;
+	schedule.table.assign(nScheduleMonths * schedule.monthStride, 0.);
+	
+	for (int m = 0; m < nScheduleMonths; m++){
+		int year = (schedule.firstMonth + m) / 12;
+		int month = (schedule.firstMonth + m) % 12 + 1;
+		
+		int index = 12 * (year - StartYear) + month - 1; //Matrix for SW and GW starts by StartYear and January (monthly Data)
+		int indexTF = year - StartYear; //Matrix for TF starts by StartYear (annual data)
 
-	switch(waterUseType) {
+		int nYears = numberOfDaysInYear(year);
+		int nMonths = numberOfDaysInMonth(month, year);
 		
-		// only water use without Transport to cities is considered
-		case 1: for (int i=0; i < array_size; i ++){
-					// changing values from m³/year or month to mm*km²/day
-					GW_day[i] = GW_day[i] / 1000 / nMonths;
-					SW_day[i] = SW_day[i] / 1000 / nMonths;
-					// adding domestic transfer to surface water net abstraciton
-					dailyUse(0,i) = GW_day[i];
-					dailyUse(1,i) = SW_day[i];
+		if (ctx.GapYearType == 1) {
+			nYears = 365;
+			if (month == 2){ 
+				nMonths = 28; 
+			}
 		}
-				break;
-		// water use including Transport to cities is considered
-		case 2: for (int i=0; i < array_size; i ++){
-					// changing values from m³/year or month to mm*km²/day
-					TF_day[i] = TF_day[i] / 1000 / nYears;
-					GW_day[i] = GW_day[i] / 1000 / nMonths;
-					SW_day[i] = SW_day[i] / 1000 / nMonths;
-					// adding domestic transfer to surface water net abstraciton
-					dailyUse(0,i) = GW_day[i];
-					dailyUse(1,i) = SW_day[i] + TF_day[i];
+		
+		double* dailyUse = schedule.table.data() + m * schedule.monthStride; // first = GW, second = SW(+TF) of every cell
+		for (int i=0; i < ctx.array_size; i ++){
+			// changing values from m³/year or month to mm*km²/day
+			double GW_day = Info_GW(index, i) / 1000 / nMonths;
+			double SW_day = Info_SW(index, i) / 1000 / nMonths;
+			dailyUse[2 * i] = GW_day;
+			dailyUse[2 * i + 1] = SW_day;
+			if (ctx.waterUseType == 2) { // water use including Transport to cities is considered
+				double TF_day = Info_TF(indexTF, i) / 1000 / nYears;
+				// adding domestic transfer to surface water net abstraciton
+				dailyUse[2 * i + 1] = SW_day + TF_day;
+			}
 		}
-				break;
-		default: stop("Error: WaterUseType should be 0, 1 or 2."); // It was already checked, should not happen
 	}
 	
-}
\ No newline at end of file
+	ctx.dailyUse = schedule.day(ctx.SimYear[0], ctx.SimMonth[0]); // until the first day is simulated
+}
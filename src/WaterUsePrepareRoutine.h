@@ -2,12 +2,16 @@
 #define WATERUSEPREPAREROUTINE_H
 
 #include <Rcpp.h>
+#include <vector>
+#include "ModelContext.h"
 
 using namespace std;
 using namespace Rcpp;
 
 
-NumericVector WaterUseCalcMeanDemandDaily(int year, int GapYearType);
-void WaterUseCalcDaily(int waterUseType, NumericMatrix dailyUse, int year, int month, int StartYear, NumericMatrix Info_GW, NumericMatrix Info_SW, NumericMatrix Info_TF);
+void WaterUseInitMeanDemand(ModelContext& ctx);
+vector<double> WaterUseCalcMeanDemandDaily(ModelContext& ctx, int year, int GapYearType);
+const vector<double>& WaterUseMeanDemandDaily(ModelContext& ctx, int year);
+void WaterUseInitSchedule(ModelContext& ctx);
  
 #endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef WATERUSESCHEDULE_H
+#define WATERUSESCHEDULE_H
+
+#include <Rcpp.h>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+using namespace Rcpp;
+
+// water use of one day in mm*km²/day: row 0 = GW, row 1 = SW (+ TF), same element access as the NumericMatrix(2, array_size)
+// that was filled every day before; only points into the table of WaterUseSchedule (no copy)
+class WaterUseDay {
+public:
+	WaterUseDay() : values(NULL), nCells(0) {}
+	WaterUseDay(const double* values, int nCells) : values(values), nCells(nCells) {}
+
+	double operator()(int row, int cell) const { return(values[2 * (size_t) cell + row]); }
+	const double* begin() const { return(values); }
+	int nrow() const { return(2); }
+
+	// copy for the output list (uses R API -> only in main thread)
+	NumericMatrix toMatrix() const {
+		NumericMatrix M(2, nCells);
+		if (values != NULL) {
+			copy(values, values + 2 * (size_t) nCells, M.begin());
+		}
+		return(M);
+	}
+
+private:
+	const double* values;
+	int nCells;
+};
+
+// daily water use of every month of the simulation period (see WaterUseInitSchedule()), values only change with the month,
+// so they are calculated once and every day just takes the slice of its month
+// does not use the R API, so it can be read in worker threads
+class WaterUseSchedule {
+public:
+	vector<double> table; // one slice of 2 * nCells values per month (layout of WaterUseDay), cells next to each other
+	int firstMonth = 0; // 12 * year + month - 1 of the first slice
+	size_t monthStride = 0; // 2 * nCells, or 0 if all months have the same slice (no water use)
+	int nCells = 0;
+
+	WaterUseDay day(int year, int month) const {
+		return(WaterUseDay(table.data() + (size_t) (12 * year + month - 1 - firstMonth) * monthStride, nCells));
+	}
+};
+
+#endif
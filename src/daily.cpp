@@ -10,6 +10,7 @@
 #include "dailySoil.h"
 #include "dailySplitRunOff.h"
 #include "WaterUsePrepareRoutine.h"
+#include "ModelTools.h"
 
 using namespace Rcpp;
 using namespace std;
@@ -21,154 +22,198 @@ using namespace std;
 //' especially the snow routine and immediate RunOff generation are NOT validated therefore 
 //' have to check the simulation results also for other basins to assure a good match with WG3
 //' e.g. for european basins with snow processes and sealed areas! (Bayern?) }
+//' @param modelContext model created with initModelContext()
 //' @param timestring Datevector with dates of simulation period
 //' @return List Vwith daily water balance for whole simulaiton period as output
 //' @export
 // [[Rcpp::export]]
-List createWaterBalance(DateVector timestring){
+List createWaterBalance(SEXP modelContext, DateVector timestring){
+	ModelContext& ctx = getModelContext(modelContext);
+	return(createWaterBalance(ctx, timestring));
+}
+
+// daily water balance of the model defined in ctx
+List createWaterBalance(ModelContext& ctx, DateVector timestring){
+	
+	initSimPeriod(ctx, timestring);
+	
+	WaterBalanceOutput out;
+	initWaterBalanceOutput(ctx, out);
+	simulateWaterBalance(ctx, out);
 	
+	return(getWaterBalanceOutput(ctx, out));
+}
 
-	const int ndays = timestring.length();
-	Date startDate = timestring[0];
-	int startYear = startDate.getYear();
+// output matrices of the water balance with their names in the output list (see getWaterBalanceOutput())
+vector< pair<string, OutputMatrix*> > getWaterBalanceOutputTable(WaterBalanceOutput& out){
 	
+	vector< pair<string, OutputMatrix*> > table = {
+		{"Fluxes$PET", &out.PET},
+		{"Fluxes$PETw", &out.PETw},
+		{"Fluxes$PET_netLong", &out.PET_netLong},
+		{"Fluxes$PET_netShort", &out.PET_netShort},
+		{"Fluxes$InterceptionEvapo", &out.Flux_InterceptionEvapo},
+		{"Fluxes$Throughfall", &out.Flux_Throughfall},
+		{"Fluxes$Flux_SnowMelt", &out.Flux_SnowMelt},
+		{"Fluxes$Flux_Sublimation", &out.Flux_Sublimation},
+		{"Fluxes$immediateRunoff", &out.Flux_ImmediateRunoff},
+		{"Fluxes$dailyRunoff", &out.Flux_dailyRunoff},
+		{"Fluxes$soilWaterOverflow", &out.Flux_soilWaterOverflow},
+		{"Fluxes$Flux_dailyAET", &out.Flux_dailyAET},
+		{"Fluxes$Flux_soilIn", &out.Flux_soilIn},
+		{"Fluxes$dailyLocalSWRunoff", &out.Flux_dailyLocalSWRunoff},
+		{"Fluxes$dailyLocalGWRunoff", &out.Flux_dailyLocalGWRunoff},
+		{"Fluxes$dailyGWRecharge", &out.Flux_dailyGWRecharge},
+		{"Fluxes$Flux_dailyWaterUseGW", &out.Flux_dailyWaterUseGW},
+		{"Storages$CanopyContent", &out.Storage_CanopyContent},
+		{"Storages$SnowContent", &out.Storage_SnowContent},
+		{"Storages$SoilContent", &out.Storage_SoilContent},
+		{"Storages$GroundwaterContent", &out.Storage_GroundwaterContent}
+	};
+	return(table);
+}
 
-	//CREATING OUTPUT
-	NumericMatrix Flux_InterceptionEvapo (ndays, array_size);
-	NumericMatrix PET (ndays, array_size);
-	NumericMatrix PET_netLong (ndays, array_size);
-	NumericMatrix PET_netShort (ndays, array_size);
-	NumericMatrix PETw (ndays, array_size);
-	NumericMatrix Flux_Throughfall( ndays, array_size);
-	NumericMatrix Flux_SnowMelt( ndays, array_size);
-	NumericMatrix Flux_Sublimation( ndays, array_size);
-	NumericMatrix Flux_ImmediateRunoff (ndays, array_size);
-	NumericMatrix Flux_dailyAET (ndays, array_size);
-	NumericMatrix Flux_dailyRunoff (ndays, array_size);
-	NumericMatrix Flux_soilIn (ndays, array_size);
-	NumericMatrix Flux_soilWaterOverflow (ndays, array_size);
-	NumericMatrix Flux_dailyGWRecharge (ndays, array_size);
-	NumericMatrix Flux_dailyLocalSWRunoff (ndays, array_size);
-	NumericMatrix Flux_dailyLocalGWRunoff (ndays, array_size);
-	NumericMatrix Flux_dailyWaterUseGW (ndays, array_size);
-	
-	NumericMatrix Storage_CanopyContent (ndays, array_size);
-	NumericMatrix Storage_SnowContent (ndays, array_size);
-	NumericMatrix Storage_SoilContent (ndays, array_size);
-	NumericMatrix Storage_GroundwaterContent (ndays, array_size);
+// allocates output matrices of the water balance (uses R API -> only in main thread)
+// matrices that are not requested in spec are not allocated, so they are not written during the simulation (see saveDay())
+void initWaterBalanceOutput(ModelContext& ctx, WaterBalanceOutput& out, const OutputSpec& spec){
 	
+	initOutputPeriods(ctx, spec.timestep); // number of rows (days, months, years)
+	
+	vector< pair<string, OutputMatrix*> > table = getWaterBalanceOutputTable(out);
+	for (size_t i = 0; i < table.size(); i++){
+		if (spec.keep(table[i].first)){
+			*table[i].second = OutputMatrix(ctx.nOutputPeriods, ctx.array_size);
+		}
+	}
+}
+
+// simulation of the water balance for the simulation period (initSimPeriod()) - does not use the R API
+void simulateWaterBalance(ModelContext& ctx, WaterBalanceOutput& out){
+	
+	const int ndays = ctx.ndays;
 	
 	for (int time = 0; time < ndays; time++){
 		
-		Date SimDate = timestring[time];
-		int year = SimDate.getYear();
-		int month = SimDate.getMonth();
-		int dayDate = SimDate.getDay();
-		int DOY = min(SimDate.getYearday(), 365); //1-365 - small differences in computed PET will arrive when leap year (29.02) is neglected in model settings and long/shortwave downward radiation is estimated
-		// 31 and 30 december is always set to 365 because estimation of longwave and shortwave radiation allows only values between 1-365
-		// could be improved in the future that 29.02 is set to 60.5 if it occurs --> own DOY-function needs to be implemented therfore! e.g. https://mariusbancila.ro/blog/2017/08/03/computing-day-of-year-in-c/
-		
-		if (GapYearType == 1) { //avoid somulation of the 29.02 to compare modelling result to WG3
-			if ((dayDate == 29) && (month == 2)){
+		if (ctx.GapYearType == 1) { //avoid somulation of the 29.02 to compare modelling result to WG3
+			if ((ctx.SimDay[time] == 29) && (ctx.SimMonth[time] == 2)){
 				continue;
 			}
 		}
 		
-		
-		//to consider Water Use in Groundwater --> makes model quite slow!
-		WaterUseCalcDaily(waterUseType, dailyUse, year, month, startYear, Info_GW, Info_SW, Info_TF);
+		waterBalanceDay(ctx, time);
+		saveWaterBalanceDay(ctx, out, time);
+	}
+}
 
-		
-		dailyEffPrec.fill(0); // for every day the effective precipitation flux is set to zero
-		dailySnowMelt.fill(0); // for every day the snow melt flux is set to zero
-		dailySnowEvapo.fill(0); // for every day the sublimation flux is set to zero
-		
-		
-		//determine PET (because it is also dependend on G_snow)
-		NumericVector PETw_day = dailyEvaporation2(time, "water",G_snow, G_PETnetShort,G_PETnetLong, DOY);
-		NumericVector PET_day = dailyEvaporation2(time, "land",G_snow,G_PETnetShort,G_PETnetLong, DOY);
-		PET(time,_) = PET_day;
-		PETw(time,_) = PETw_day;
-		PET_netLong(time,_) = G_PETnetLong;
-		PET_netShort(time,_) = G_PETnetShort;
-		
-		
-		
-		//interception 
-		dailyInterception(time, G_canopyWaterContent, 
-					   daily_prec_to_soil,  
-					   dailySoilPET,
-					   dailyCanopyEvapo, PET_day);  //G_canopyWaterContent, daily_prec_to_soil, dailyCanopyEvapo
+// vertical water balance of all cells for one day of the simulation period - does not use the R API
+void waterBalanceDay(ModelContext& ctx, int time){
+	
+	int year = ctx.SimYear[time];
+	int month = ctx.SimMonth[time];
+	int DOY = ctx.SimDOY[time]; //1-365
+	
+	//to consider Water Use in Groundwater --> makes model quite slow!
+	ctx.dailyUse = ctx.waterUseSchedule.day(year, month); // see WaterUseInitSchedule()
 
-		Storage_CanopyContent(time,_) = G_canopyWaterContent;
-		Flux_Throughfall(time,_) = daily_prec_to_soil;
-		Flux_InterceptionEvapo(time,_) = dailyCanopyEvapo;
+	
+	ctx.dailyEffPrec.fill(0); // for every day the effective precipitation flux is set to zero
+	ctx.dailySnowMelt.fill(0); // for every day the snow melt flux is set to zero
+	ctx.dailySnowEvapo.fill(0); // for every day the sublimation flux is set to zero
+	
+	
+	//determine PET (because it is also dependend on G_snow)
+	dailyEvaporation2(ctx, time, ctx.G_snow, ctx.G_PETnetShort, ctx.G_PETnetLong, DOY, ctx.dailyPET, ctx.dailyPETw);
+	
+	//interception 
+	dailyInterception(ctx, time, ctx.G_canopyWaterContent, 
+				   ctx.daily_prec_to_soil,  
+				   ctx.dailySoilPET,
+				   ctx.dailyCanopyEvapo, ctx.dailyPET);  //G_canopyWaterContent, daily_prec_to_soil, dailyCanopyEvapo
 
-		
-		//snow processes create
-		dailySnow(time, daily_prec_to_soil, G_snow, G_snowWaterEquivalent,
-					dailySnowMelt, dailySnowEvapo, thresh_elev, dailyEffPrec,
-					dailySoilPET);
-		Storage_SnowContent(time,_) = G_snow;
-		Flux_SnowMelt(time,_) = dailySnowMelt;
-		Flux_Sublimation(time,_) = dailySnowEvapo;
-		
-		//run-off from sealed area --> immediate run-off
-		dailyImmediateRunoff(dailyEffPrec, immediate_runoff);
-		Flux_ImmediateRunoff(time,_) = immediate_runoff;
-		
-		//run-off from non-sealed area
-		Flux_soilIn(time,_) = dailyEffPrec;
-		dailySoil(dailyEffPrec, immediate_runoff,dailySoilPET, 
-				dailyCanopyEvapo, dailySnowEvapo, 
-				G_soilWaterContent, dailyAET, daily_runoff, soil_water_overflow);
-		Storage_SoilContent(time,_) = G_soilWaterContent;
-		Flux_dailyAET(time,_) = dailyAET;
-		Flux_dailyRunoff(time,_) = daily_runoff;
-		Flux_soilWaterOverflow(time,_) = soil_water_overflow;
-		
-		
-		//splitting of run-off
-		dailySplitRunOff(time, SimDate, daily_runoff, soil_water_overflow,immediate_runoff,
-				daily_gw_recharge, G_groundwater, G_dailyLocalSurfaceRunoff, 
-				G_dailyLocalGWRunoff, G_dailyUseGW, dailyUse);
-				
-		Storage_GroundwaterContent(time,_) = G_groundwater;
-		Flux_dailyGWRecharge(time,_) = daily_gw_recharge;
-		Flux_dailyLocalSWRunoff(time,_) = G_dailyLocalSurfaceRunoff;
-		Flux_dailyLocalGWRunoff(time,_) = G_dailyLocalGWRunoff;
-		Flux_dailyWaterUseGW(time, _) = G_dailyUseGW;
+	
+	//snow processes create
+	dailySnow(ctx, time, ctx.daily_prec_to_soil, ctx.G_snow, ctx.G_snowWaterEquivalent,
+				ctx.dailySnowMelt, ctx.dailySnowEvapo, ctx.thresh_elev, ctx.dailyEffPrec,
+				ctx.dailySoilPET);
+	
+	//run-off from sealed area --> immediate run-off
+	dailyImmediateRunoff(ctx, ctx.dailyEffPrec, ctx.immediate_runoff);
+	
+	//run-off from non-sealed area
+	dailySoil(ctx, ctx.dailyEffPrec, ctx.immediate_runoff,ctx.dailySoilPET, 
+			ctx.dailyCanopyEvapo, ctx.dailySnowEvapo, 
+			ctx.G_soilWaterContent, ctx.dailyAET, ctx.daily_runoff, ctx.soil_water_overflow);
+	
+	
+	//splitting of run-off
+	dailySplitRunOff(ctx, time, ctx.daily_runoff, ctx.soil_water_overflow,ctx.immediate_runoff,
+			ctx.daily_gw_recharge, ctx.G_groundwater, ctx.G_dailyLocalSurfaceRunoff, 
+			ctx.G_dailyLocalGWRunoff, ctx.G_dailyUseGW, ctx.dailyUse);
+}
 
-	}
+// saves states and fluxes of one day, matrices that are not allocated are skipped (see saveDay())
+// none of the fluxes saved here is changed by a later process of the same day, so it can be done after waterBalanceDay()
+void saveWaterBalanceDay(ModelContext& ctx, WaterBalanceOutput& out, int time){
+	
+	saveDay(ctx, out.PET, time, ctx.dailyPET);
+	saveDay(ctx, out.PETw, time, ctx.dailyPETw);
+	saveDay(ctx, out.PET_netLong, time, ctx.G_PETnetLong);
+	saveDay(ctx, out.PET_netShort, time, ctx.G_PETnetShort);
+	
+	saveDay(ctx, out.Storage_CanopyContent, time, ctx.G_canopyWaterContent);
+	saveDay(ctx, out.Flux_Throughfall, time, ctx.daily_prec_to_soil);
+	saveDay(ctx, out.Flux_InterceptionEvapo, time, ctx.dailyCanopyEvapo);
+	
+	saveDay(ctx, out.Storage_SnowContent, time, ctx.G_snow);
+	saveDay(ctx, out.Flux_SnowMelt, time, ctx.dailySnowMelt);
+	saveDay(ctx, out.Flux_Sublimation, time, ctx.dailySnowEvapo);
+	
+	saveDay(ctx, out.Flux_ImmediateRunoff, time, ctx.immediate_runoff);
+	
+	saveDay(ctx, out.Flux_soilIn, time, ctx.dailyEffPrec);
+	saveDay(ctx, out.Storage_SoilContent, time, ctx.G_soilWaterContent);
+	saveDay(ctx, out.Flux_dailyAET, time, ctx.dailyAET);
+	saveDay(ctx, out.Flux_dailyRunoff, time, ctx.daily_runoff);
+	saveDay(ctx, out.Flux_soilWaterOverflow, time, ctx.soil_water_overflow);
+	
+	saveDay(ctx, out.Storage_GroundwaterContent, time, ctx.G_groundwater);
+	saveDay(ctx, out.Flux_dailyGWRecharge, time, ctx.daily_gw_recharge);
+	saveDay(ctx, out.Flux_dailyLocalSWRunoff, time, ctx.G_dailyLocalSurfaceRunoff);
+	saveDay(ctx, out.Flux_dailyLocalGWRunoff, time, ctx.G_dailyLocalGWRunoff);
+	saveDay(ctx, out.Flux_dailyWaterUseGW, time, ctx.G_dailyUseGW);
+}
+
+// creates output list of the water balance (uses R API -> only in main thread), frees the output buffers
+List getWaterBalanceOutput(ModelContext& ctx, WaterBalanceOutput& out){
 	
-	List Storages = List::create(Named("CanopyContent") = Storage_CanopyContent, 
-								 Named("SnowContent") = Storage_SnowContent, 
-								 Named("SoilContent") = Storage_SoilContent, 
-								 Named("GroundwaterContent") = Storage_GroundwaterContent);
+	List Storages = List::create(Named("CanopyContent") = outputToMatrix(ctx, out.Storage_CanopyContent), 
+								 Named("SnowContent") = outputToMatrix(ctx, out.Storage_SnowContent), 
+								 Named("SoilContent") = outputToMatrix(ctx, out.Storage_SoilContent), 
+								 Named("GroundwaterContent") = outputToMatrix(ctx, out.Storage_GroundwaterContent));
 	
-	List Fluxes = List::create(Named("PET") = PET, 
-								Named("PETw") = PETw, 
-								Named("PET_netLong") = PET_netLong,
-								Named("PET_netShort") = PET_netShort,
+	List Fluxes = List::create(Named("PET") = outputToMatrix(ctx, out.PET), 
+								Named("PETw") = outputToMatrix(ctx, out.PETw), 
+								Named("PET_netLong") = outputToMatrix(ctx, out.PET_netLong),
+								Named("PET_netShort") = outputToMatrix(ctx, out.PET_netShort),
 								
-								Named("dailyUse") = dailyUse,
+								Named("dailyUse") = ctx.dailyUse.toMatrix(),
 								
-								Named("InterceptionEvapo") = Flux_InterceptionEvapo, 
-								Named("Throughfall") = Flux_Throughfall,  
+								Named("InterceptionEvapo") = outputToMatrix(ctx, out.Flux_InterceptionEvapo), 
+								Named("Throughfall") = outputToMatrix(ctx, out.Flux_Throughfall),  
 								
-								Named("Flux_SnowMelt") = Flux_SnowMelt,
-								Named("Flux_Sublimation") = Flux_Sublimation,
+								Named("Flux_SnowMelt") = outputToMatrix(ctx, out.Flux_SnowMelt),
+								Named("Flux_Sublimation") = outputToMatrix(ctx, out.Flux_Sublimation),
 								
-								Named("immediateRunoff") = Flux_ImmediateRunoff,
+								Named("immediateRunoff") = outputToMatrix(ctx, out.Flux_ImmediateRunoff),
 								
-								Named("dailyRunoff") = Flux_dailyRunoff, 
-								Named("soilWaterOverflow") = Flux_soilWaterOverflow, 
-								Named("Flux_dailyAET") = Flux_dailyAET,
-								Named("Flux_soilIn") = Flux_soilIn,
-								Named("dailyLocalSWRunoff") = Flux_dailyLocalSWRunoff , 
-								Named("dailyLocalGWRunoff") = Flux_dailyLocalGWRunoff, 
-								Named("dailyGWRecharge") = Flux_dailyGWRecharge,
-								Named("Flux_dailyWaterUseGW") = Flux_dailyWaterUseGW);
+								Named("dailyRunoff") = outputToMatrix(ctx, out.Flux_dailyRunoff), 
+								Named("soilWaterOverflow") = outputToMatrix(ctx, out.Flux_soilWaterOverflow), 
+								Named("Flux_dailyAET") = outputToMatrix(ctx, out.Flux_dailyAET),
+								Named("Flux_soilIn") = outputToMatrix(ctx, out.Flux_soilIn),
+								Named("dailyLocalSWRunoff") = outputToMatrix(ctx, out.Flux_dailyLocalSWRunoff) , 
+								Named("dailyLocalGWRunoff") = outputToMatrix(ctx, out.Flux_dailyLocalGWRunoff), 
+								Named("dailyGWRecharge") = outputToMatrix(ctx, out.Flux_dailyGWRecharge),
+								Named("Flux_dailyWaterUseGW") = outputToMatrix(ctx, out.Flux_dailyWaterUseGW));
 				
 	List L = List::create(Named("Fluxes") = Fluxes, Named("Storages") = Storages);
 	return(L);
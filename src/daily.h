@@ -1,4 +1,7 @@
 #include <Rcpp.h>
+#include "ModelContext.h"
+#include "ModelTools.h"
+#include "OutputMatrix.h"
 
 using namespace std;
 using namespace Rcpp;
@@ -6,6 +9,40 @@ using namespace Rcpp;
 #ifndef DAILY_H
 #define DAILY_H
 
-List createWaterBalance(DateVector timestring);
+// output matrices of the daily water balance (see OutputMatrix)
+// they are allocated before the simulation starts, so that simulateWaterBalance() does not need the R API (see runModelBatch())
+struct WaterBalanceOutput {
+	OutputMatrix Flux_InterceptionEvapo;
+	OutputMatrix PET;
+	OutputMatrix PET_netLong;
+	OutputMatrix PET_netShort;
+	OutputMatrix PETw;
+	OutputMatrix Flux_Throughfall;
+	OutputMatrix Flux_SnowMelt;
+	OutputMatrix Flux_Sublimation;
+	OutputMatrix Flux_ImmediateRunoff;
+	OutputMatrix Flux_dailyAET;
+	OutputMatrix Flux_dailyRunoff;
+	OutputMatrix Flux_soilIn;
+	OutputMatrix Flux_soilWaterOverflow;
+	OutputMatrix Flux_dailyGWRecharge;
+	OutputMatrix Flux_dailyLocalSWRunoff;
+	OutputMatrix Flux_dailyLocalGWRunoff;
+	OutputMatrix Flux_dailyWaterUseGW;
+	
+	OutputMatrix Storage_CanopyContent;
+	OutputMatrix Storage_SnowContent;
+	OutputMatrix Storage_SoilContent;
+	OutputMatrix Storage_GroundwaterContent;
+};
+
+List createWaterBalance(ModelContext& ctx, DateVector timestring);
+
+vector< pair<string, OutputMatrix*> > getWaterBalanceOutputTable(WaterBalanceOutput& out);
+void initWaterBalanceOutput(ModelContext& ctx, WaterBalanceOutput& out, const OutputSpec& spec = OutputSpec());
+void simulateWaterBalance(ModelContext& ctx, WaterBalanceOutput& out);
+void waterBalanceDay(ModelContext& ctx, int time);
+void saveWaterBalanceDay(ModelContext& ctx, WaterBalanceOutput& out, int time);
+List getWaterBalanceOutput(ModelContext& ctx, WaterBalanceOutput& out);
 
 #endif
\ No newline at end of file
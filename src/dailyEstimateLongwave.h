@@ -1,7 +1,7 @@
 #ifndef DAILYESTIMATELONGWAVE_h
 #define DAILYESTIMATELONGWAVE_h
 
-double dailyEstimateLongwave(int n, int DOY, double dailyTempC, double dailyShortWave);
+double dailyEstimateLongwave(ModelContext& ctx, int n, int DOY, double dailyTempC, double dailyShortWave);
  
 #endif
 
@@ -1,7 +1,7 @@
 #ifndef DAILYEVAPORATION_H
 #define DAILYEVAPORATION_H
 
-NumericVector dailyEvaporation(int day, String Type, const NumericVector G_snow);
+NumericVector dailyEvaporation(ModelContext& ctx, int day, String Type, const NumericVector G_snow);
  
 #endif
 
@@ -8,60 +8,48 @@ using namespace Rcpp;
 using namespace std;
 
 //' @title Calcualting daily potential evapotranspiration
-//' @description using Priestley-Taylor approach for calculation of PET
+//' @description using Priestley-Taylor approach for calculation of PET, land and open water PET in one pass over the cells
+//' (both only differ in albedo, so e_s, latent heat, gamma and longwave radiation are calculated once per cell)
+//' @param ctx ModelContext of the model
 //' @param day day as integer (0 = first day of simulation period)
-//' @param Type of PET as string ("water") or other 
 //' @param G_snow actual filling of snow storage (to account for snow>3mm --> using snow albedo)
-//' @param G_PETnetShort net shortwave radiation 
-//' @param G_PETnetLong net longwave radiation 
+//' @param G_PETnetShort net shortwave radiation of land (output)
+//' @param G_PETnetLong net longwave radiation (output)
 //' @param DOY Day of the year (1,...,365) - if leap year, 366 is transformed to 365
-//' @return PET_day in mm/d
+//' @param PET_day potential evapotranspiration of land in mm/d (output)
+//' @param PETw_day potential evaporation of open water in mm/d (output)
 //' @export
 ///////////////////////////////////////// Potential Evaporation //////////////////////////////////////////////////////////////////////////////
 
 
-NumericVector dailyEvaporation2(int day, String Type, const NumericVector G_snow, NumericVector G_PETnetShort, NumericVector G_PETnetLong, int DOY){
-  
-  //const int ncols = Temp.ncol(); //should be equal to array size
-  NumericVector albedoToUse (array_size);
-  NumericVector PET_day (array_size);
+void dailyEvaporation2(ModelContext& ctx, int day, const NumericVector& G_snow, NumericVector& G_PETnetShort, NumericVector& G_PETnetLong, int DOY, 
+						NumericVector& PET_day, NumericVector& PETw_day){
   
   //const double sigma = 0.000000004903; // MJ /(m2 * K4 * day) - Stefan-Boltzmann constant (5.67×10-8 Wm-2 K-4)
   //const double G = 0; // neglected
   //const double gamma = 0.65; // 65 Pa/K Maniak(2015)
   
-  
-  //creating albedoToUse depending on PET type (water/land)
-  if (Type == "water") { 
-	for (int i=0; i < array_size; i++){ //does not work!
-        albedoToUse[i] = 0.08; //openWaterAlbedo
-	}
-  } else {
-	for (int j=0; j < array_size; j++){
-         albedoToUse[j] = albedo[j];
-		 if (G_snow[j] > 3.){ //check if there is a mean snow cover > 3mm an use snow albedo than
-			 albedoToUse[j] = albedoSnow[j];
-		 }
-	}
-  }
+  const double openWaterAlbedo = 0.08;
+  const double stefan_boltz_const = 0.000000004903; // MJ /(m2 * K4 * day)
+  const double atmos_pres = 101.3;
+  const double c3 = 0.0016286 * atmos_pres;
   
   //starting iteration through days and cells
-	for (int col = 0; col < array_size; col++){
+	for (int col = 0; col < ctx.array_size; col++){
 		
 
-		double dailyShortWave = Rs(day, col); //[W/m2]
-		double dailyLongWave = Rl(day,col); //[W/m2]
+		double dailyShortWave = ctx.Rs(day, col); //[W/m2]
 		double net_long_wave_rad;
 			
 		//ccalculation scheme form original ModelCode
-		double albedo = albedoToUse[col];
-		double dailyTempC = Temp(day,col);
-		double emissivityCol = emissivity[col]; // land use class dependent emissivity
-		double alpha = alphaPT[col];
-		double temp_K = dailyTempC + 273.2; // [K]
-		const double stefan_boltz_const = 0.000000004903; // MJ /(m2 * K4 * day)
+		//albedo of land (albedo of water is openWaterAlbedo)
+		double albedo = ctx.par.rad.albedo[col];
+		if (G_snow[col] > 3.){ //check if there is a mean snow cover > 3mm an use snow albedo than
+			albedo = ctx.par.rad.albedoSnow[col];
+		}
+		double dailyTempC = ctx.Temp(day,col);
+		double alpha = ctx.par.rad.alphaPT[col];
 		double lat_heat;
-		double dailyPET; 
 		
 		double temp2 = dailyTempC + 237.3;
 		double e_s = 0.6108 * exp(17.27 * dailyTempC / temp2);
@@ -75,33 +63,30 @@ NumericVector dailyEvaporation2(int day, String Type, const NumericVector G_snow
 		
 		double solar_rad = conv_Wm2_to_mmd * dailyShortWave; //[mm/day]
 		double net_short_wave_rad = solar_rad * (1. - albedo);
+		double net_short_wave_rad_w = solar_rad * (1. - openWaterAlbedo);
 		
 		// or estimating it in another way after Kaspar 2004
-		if (calcLong == 1) {
-			net_long_wave_rad = dailyEstimateLongwave(col, DOY, dailyTempC, dailyShortWave); //mm/d
+		if (ctx.calcLong == 1) {
+			net_long_wave_rad = dailyEstimateLongwave(ctx, col, DOY, dailyTempC, dailyShortWave); //mm/d
 		} else {
-			double long_wave_rad_in = conv_Wm2_to_mmd * dailyLongWave;; // unit: mm/d
-			double long_wave_rad_out = emissivityCol * stefan_boltz_const * pow(temp_K, 4.) / lat_heat; // unit: mm/d
+			double temp_K = dailyTempC + 273.2; // [K]
+			double long_wave_rad_in = conv_Wm2_to_mmd * ctx.Rl(day,col); // unit: mm/d
+			double long_wave_rad_out = ctx.par.rad.emissivity[col] * stefan_boltz_const * pow(temp_K, 4.) / lat_heat; // unit: mm/d
 			net_long_wave_rad = long_wave_rad_in - long_wave_rad_out; // unit: mm/d
 		}
 		
-				
-		double net_rad = net_short_wave_rad + net_long_wave_rad;
-		double atmos_pres = 101.3;
 		double inc_svp = 4098. * e_s / (temp2 * temp2); 
-		double c3 = 0.0016286 * atmos_pres;
 		double gamma = c3 / lat_heat;
 		
-		if (net_rad <= 0.) {
-			dailyPET = 0.;
-		} else {
-			dailyPET = alpha * (inc_svp * net_rad) / (inc_svp + gamma);	// [mm/day]
-		}
-		PET_day[col] = dailyPET;
+		double net_rad = net_short_wave_rad + net_long_wave_rad;
+		double net_rad_w = net_short_wave_rad_w + net_long_wave_rad;
+		
+		// [mm/day]
+		PET_day[col] = (net_rad <= 0.) ? 0. : alpha * (inc_svp * net_rad) / (inc_svp + gamma);
+		PETw_day[col] = (net_rad_w <= 0.) ? 0. : alpha * (inc_svp * net_rad_w) / (inc_svp + gamma);
 		G_PETnetShort[col] = net_short_wave_rad;
 		G_PETnetLong[col] = net_long_wave_rad;
 	}
 		
-  // potential evaporation in mm/d
-  return(PET_day);
+  // potential evaporation in mm/d is written to PET_day and PETw_day
 }
@@ -1,7 +1,8 @@
 #ifndef DAILYEVAPORATION2_H
 #define DAILYEVAPORATION2_H
 
-NumericVector dailyEvaporation2(int day, String Type, const NumericVector G_snow, NumericVector G_PETnetShort, NumericVector G_PETnetLong, int DOY);
+void dailyEvaporation2(ModelContext& ctx, int day, const NumericVector& G_snow, NumericVector& G_PETnetShort, NumericVector& G_PETnetLong, int DOY, 
+						NumericVector& PET_day, NumericVector& PETw_day);
  
 #endif
 
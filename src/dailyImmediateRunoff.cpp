@@ -2,6 +2,7 @@
 #include <math.h>
 #include "initModel.h"
 #include "dailyImmediateRunoff.h"
+#include "VectorMath.h"
 
 using namespace Rcpp;
 using namespace std;
@@ -9,13 +10,26 @@ using namespace std;
 //' @title Calculate immediate run-off from sealed areas
 //# @description { rcpp function to calculate immediate run-off based on  built-up fraction
 //' over built-up areas 50 percent of precipitation is immediate runoff }
+//' @param ctx ModelContext of the model
 //' @param dailyEffPrec effective precipitation (throughfall of canopy + snowmelt water - fallen snow)
 //' @param immediate_runoff run-off that contributed directly to the fast surface run-off in mm/d
 //' @export
 ///////////////////////////////////////// immediate runoff //////////////////////////////////////////////////////////////////////////////
 
+// one cell of dailyImmediateRunoff() for runVectorKernel()
+struct ImmediateRunoffKernel {
+	double runoffFracBuiltUp;
+	const param_t* GBUILTUP;
+	double* dailyEffPrec;
+	double* immediate_runoff;
 
-void dailyImmediateRunoff(NumericVector dailyEffPrec, NumericVector immediate_runoff){
+	VECTOR_INLINE void operator()(int cell){
+		immediate_runoff[cell] = runoffFracBuiltUp * dailyEffPrec[cell] * GBUILTUP[cell];
+		dailyEffPrec[cell] -= immediate_runoff[cell];
+	}
+};
+
+void dailyImmediateRunoff(ModelContext& ctx, NumericVector& dailyEffPrec, NumericVector& immediate_runoff){
 	
 	//const NumericVector GBUILTUP = Environment::global_env()["GBUILTUP"]; //amount of sealed ares in grid [-]
 	//const NumericVector G_CORR_FACTOR = Environment::global_env()["G_CORR_FACTOR"]; //amount of sealed ares in grid [-]
@@ -26,8 +40,14 @@ void dailyImmediateRunoff(NumericVector dailyEffPrec, NumericVector immediate_ru
 	//NumericVector immediate_runoff = Environment::global_env()["immediate_runoff"]; //amount of sealed ares in grid [-]
 	//NumericVector dailyEffPrec = Environment::global_env()["dailyEffPrec"]; //amount of sealed ares in grid [-]
 	
-	for (int cell = 0; cell < array_size; cell++){
-		immediate_runoff[cell] = runoffFracBuiltUp * dailyEffPrec[cell] * GBUILTUP[cell];
+	if (ctx.simdLevel > 0) {
+		ImmediateRunoffKernel kernel = {ctx.runoffFracBuiltUp, ctx.par.soil.GBUILTUP, dailyEffPrec.begin(), immediate_runoff.begin()};
+		runVectorKernel(ctx.simdLevel, kernel, ctx.array_size);
+		return;
+	}
+	
+	for (int cell = 0; cell < ctx.array_size; cell++){
+		immediate_runoff[cell] = ctx.runoffFracBuiltUp * dailyEffPrec[cell] * ctx.par.soil.GBUILTUP[cell];
 		dailyEffPrec[cell] -= immediate_runoff[cell];
 		//immediate_runoff[cell] *= G_CORR_FACTOR[cell];
 	}
@@ -1,6 +1,6 @@
 #ifndef DAILYIMMEDIATERUNOFF_H
 #define DAILYIMMEDIATERUNOFF_H
- void dailyImmediateRunoff(NumericVector dailyEffPrec, NumericVector immediate_runoff);
+ void dailyImmediateRunoff(ModelContext& ctx, NumericVector& dailyEffPrec, NumericVector& immediate_runoff);
 #endif
 
 
@@ -2,6 +2,7 @@
 #include <math.h>
 #include "initModel.h"
 #include "dailyInterception.h"
+#include "VectorMath.h"
 
 using namespace Rcpp;
 using namespace std;
@@ -9,6 +10,7 @@ using namespace std;
 
 //' @title Interception storage implementation
 //' @description calculation of interception storage with variable interception storage 
+//' @param ctx ModelContext of the model
 //' @param day day of simulation period as integer
 //' @param G_canopyWaterContent interception storage 
 //' @param daily_prec_to_soil throughfall from canopy
@@ -18,34 +20,44 @@ using namespace std;
 //' @export
 ///////////////////////////////////////// Interception //////////////////////////////////////////////////////////////////////////////
 
-void dailyInterception(int day, NumericVector G_canopyWaterContent, NumericVector daily_prec_to_soil,  NumericVector dailySoilPET,
-		NumericVector dailyCanopyEvapo, const NumericVector dailyPET){
-   
-  //const int cells = G_canopyWaterContent.length();
-  double max_canopy_storage;
-  double canopy_deficiency;
-  double canopy_water_content; 
+// first part of the interception of one cell (original scalar code): precipitation fills the canopy,
+// returns false if there is no interception storage (cell is finished then)
+static inline bool interceptionFilling(ModelContext& ctx, int day, int cell, NumericVector& G_canopyWaterContent, NumericVector& daily_prec_to_soil,  NumericVector& dailySoilPET,
+		NumericVector& dailyCanopyEvapo, const NumericVector& dailyPET, double& max_canopy_storage){
   
-  NumericVector dailyLAI = dailyLaiAll(day,_); //getting Interception Storage for the day
-  NumericVector dailyPrec = Prec(day,_); //getting Precipitation for the day
+  double canopy_deficiency;
   
-  for (int cell = 0; cell < array_size; cell++){
+  const double dailyLAI = ctx.dailyLai[cell]; //getting Interception Storage for the day (see updateLAIdaily())
+  const double dailyPrec = ctx.Prec(day, cell); //getting Precipitation for the day
   
   // calculation of LAI has been moved before calculations of albedo starts
-	if ((dailyLAI[cell] > 0.00001) & (maxCanopyStoragePerLAI > 0)) { //if there is interception storage available, maxCanopyStoragePerLAI can be used to turn interception off
-		max_canopy_storage = maxCanopyStoragePerLAI * dailyLAI[cell];	// [mm]
+	if ((dailyLAI > 0.00001) & (ctx.maxCanopyStoragePerLAI > 0)) { //if there is interception storage available, maxCanopyStoragePerLAI can be used to turn interception off
+		max_canopy_storage = ctx.maxCanopyStoragePerLAI * dailyLAI;	// [mm]
 		canopy_deficiency = max_canopy_storage - G_canopyWaterContent[cell]; //space left in interception storage, due to variable storage negative values are possible
-		if (dailyPrec[cell] < canopy_deficiency) {
-		  G_canopyWaterContent[cell] += dailyPrec[cell];
+		if (dailyPrec < canopy_deficiency) {
+		  G_canopyWaterContent[cell] += dailyPrec;
 		  daily_prec_to_soil[cell] = 0.;
 		} else { //Throughfall to soil
 		  G_canopyWaterContent[cell] = max_canopy_storage;
-		  daily_prec_to_soil[cell] = dailyPrec[cell] - canopy_deficiency;
+		  daily_prec_to_soil[cell] = dailyPrec - canopy_deficiency;
 		}
-		
+		return(true);
+	} else { //no interception storage is available
+		daily_prec_to_soil[cell] = dailyPrec;
+		dailySoilPET[cell] = dailyPET[cell];
+		dailyCanopyEvapo[cell] = 0.0;
+		return(false);
+	}
+}
+
+// second part of the interception of one cell (original scalar code): evaporation from the canopy
+// evapoRatio = pow((canopy_water_content / max_canopy_storage), ctx.canopyEvapoExp)
+static inline void interceptionEvaporation(int cell, double evapoRatio, NumericVector& G_canopyWaterContent, NumericVector& dailySoilPET,
+		NumericVector& dailyCanopyEvapo, const NumericVector& dailyPET){
+  
 		//calculation of evapotranspiration from interception storage
-		canopy_water_content = G_canopyWaterContent[cell];
-		dailyCanopyEvapo[cell] = dailyPET[cell] * pow((canopy_water_content / max_canopy_storage), canopyEvapoExp); // canopyEvapoExp = 2/3
+		const double canopy_water_content = G_canopyWaterContent[cell];
+		dailyCanopyEvapo[cell] = dailyPET[cell] * evapoRatio; // canopyEvapoExp = 2/3
 		if (dailyCanopyEvapo[cell] > canopy_water_content) {
 		  // All the water in the canopy is evaporated. dailyCanopyEvapo has to be reduced, because
 		  // part of the energy is left and can lead to additional evapotranspiration from soil later in the program.
@@ -56,11 +68,79 @@ void dailyInterception(int day, NumericVector G_canopyWaterContent, NumericVecto
 		  G_canopyWaterContent[cell] -= dailyCanopyEvapo[cell];
 		  dailySoilPET[cell] = dailyPET[cell] - dailyCanopyEvapo[cell];
 		}
-	} else { //no interception storage is available
-		daily_prec_to_soil[cell] = dailyPrec[cell];
-		dailySoilPET[cell] = dailyPET[cell];
-		dailyCanopyEvapo[cell] = 0.0;
+}
+
+// interception of one cell (original scalar code)
+static inline void dailyInterceptionCell(ModelContext& ctx, int day, int cell, NumericVector& G_canopyWaterContent, NumericVector& daily_prec_to_soil,  NumericVector& dailySoilPET,
+		NumericVector& dailyCanopyEvapo, const NumericVector& dailyPET){
+  
+  double max_canopy_storage;
+  if (interceptionFilling(ctx, day, cell, G_canopyWaterContent, daily_prec_to_soil, dailySoilPET, dailyCanopyEvapo, dailyPET, max_canopy_storage)) {
+	interceptionEvaporation(cell, pow((G_canopyWaterContent[cell] / max_canopy_storage), ctx.canopyEvapoExp),
+						 G_canopyWaterContent, dailySoilPET, dailyCanopyEvapo, dailyPET);
+  }
+}
+
+// one cell of dailyInterception() for runVectorKernel(): same as dailyInterceptionCell() without branches
+// cells where pow() can not be replaced by simdPow() are not changed and marked in fallback
+struct InterceptionKernel {
+	const double* dailyLai;
+	const double* Prec; // day of Prec
+	double maxCanopyStoragePerLAI;
+	double canopyEvapoExp;
+	const double* dailyPET;
+	double* G_canopyWaterContent;
+	double* daily_prec_to_soil;
+	double* dailySoilPET;
+	double* dailyCanopyEvapo;
+	char* fallback;
+
+	VECTOR_INLINE void operator()(int cell){
+		const double dailyLAI = dailyLai[cell];
+		const double dailyPrec = Prec[cell];
+		const double PET = dailyPET[cell];
+		const double content = G_canopyWaterContent[cell];
+
+		const bool storage = (dailyLAI > 0.00001) & (maxCanopyStoragePerLAI > 0); // interception storage available
+		const double max_canopy_storage = maxCanopyStoragePerLAI * dailyLAI; // [mm]
+		const double canopy_deficiency = max_canopy_storage - content;
+		const bool throughfall = !(dailyPrec < canopy_deficiency);
+		const double canopy_water_content = simdSelect(throughfall, max_canopy_storage, content + dailyPrec);
+		const double ratio = simdSelect(storage, canopy_water_content / max_canopy_storage, 1.);
+		const bool valid = simdPowValid(ratio);
+		const double evapo = PET * simdPow(ratio, canopyEvapoExp);
+		const bool dry = evapo > canopy_water_content; // all the water in the canopy is evaporated
+		const bool change = storage & valid;
+
+		G_canopyWaterContent[cell] = simdSelect(change, simdSelect(dry, 0.0, canopy_water_content - evapo), content);
+		daily_prec_to_soil[cell] = simdSelect(storage, simdSelect(throughfall, dailyPrec - canopy_deficiency, 0.), dailyPrec);
+		dailyCanopyEvapo[cell] = simdSelect(storage, simdSelect(dry, canopy_water_content, evapo), 0.0);
+		dailySoilPET[cell] = simdSelect(storage, simdSelect(dry, PET - canopy_water_content, PET - evapo), PET);
+		fallback[cell] = storage & !valid;
 	}
+};
+
+void dailyInterception(ModelContext& ctx, int day, NumericVector& G_canopyWaterContent, NumericVector& daily_prec_to_soil,  NumericVector& dailySoilPET,
+		NumericVector& dailyCanopyEvapo, const NumericVector& dailyPET){
+   
+  //const int cells = G_canopyWaterContent.length();
+  updateLAIdaily(ctx, day); // LAI of the day
+  
+  if (ctx.simdLevel > 0) {
+	InterceptionKernel kernel = {ctx.dailyLai.data(), ctx.Prec.row(day), ctx.maxCanopyStoragePerLAI, ctx.canopyEvapoExp,
+							  dailyPET.begin(), G_canopyWaterContent.begin(), daily_prec_to_soil.begin(), dailySoilPET.begin(), dailyCanopyEvapo.begin(),
+							  ctx.vectorFallback.data()};
+	runVectorKernel(ctx.simdLevel, kernel, ctx.array_size);
+	for (int cell = 0; cell < ctx.array_size; cell++){
+		if (ctx.vectorFallback[cell]) {
+			dailyInterceptionCell(ctx, day, cell, G_canopyWaterContent, daily_prec_to_soil, dailySoilPET, dailyCanopyEvapo, dailyPET);
+		}
+	}
+	return;
+  }
+  
+  for (int cell = 0; cell < ctx.array_size; cell++){
+	dailyInterceptionCell(ctx, day, cell, G_canopyWaterContent, daily_prec_to_soil, dailySoilPET, dailyCanopyEvapo, dailyPET);
   }
   //List L = List::create(G_canopyWaterContent, daily_prec_to_soil, dailyCanopyEvapo);
   //return(L);
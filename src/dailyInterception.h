@@ -1,7 +1,7 @@
 #ifndef DAILYINTERCEPTION_H
 #define DAILYINTERCEPTION_H
 
-void dailyInterception(int day, NumericVector G_canopyWaterContent, NumericVector daily_prec_to_soil,  NumericVector dailySoilPET,
-		NumericVector dailyCanopyEvapo, const NumericVector dailyPET);
+void dailyInterception(ModelContext& ctx, int day, NumericVector& G_canopyWaterContent, NumericVector& daily_prec_to_soil,  NumericVector& dailySoilPET,
+		NumericVector& dailyCanopyEvapo, const NumericVector& dailyPET);
  
 #endif
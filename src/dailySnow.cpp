@@ -2,13 +2,54 @@
 #include <math.h>
 #include "initModel.h"
 #include "dailySnow.h"
+#include "VectorMath.h"
 
 using namespace Rcpp;
 using namespace std;
 
 
+// one elevation band of a cell for runVectorKernel(): accumulation, sublimation and melting of snow without branches
+// (same operations as the scalar if/else code in dailySnow() -> identical results)
+// fluxes of the bands are written to evapo, rain and melt and summed up afterwards in the order of the bands
+struct SnowBandKernel {
+	const double* tempOffset; // temperature offsets of the bands of the cell (see initSnowBands())
+	double* swe; // G_snowWaterEquivalent of the cell
+	double* evapo;
+	double* rain;
+	double* melt;
+	double dailyTemp;
+	double threshTemp; // temperature at threshold elevation (see thresh_elev)
+	int firstThresh; // bands from firstThresh on get threshTemp if their SWE is > 1000 mm
+	double prec;
+	double PET;
+	double degreeDayFactor;
+	double snowFreezeTemp;
+	double snowMeltTemp;
+
+	VECTOR_INLINE void operator()(int elev){
+		double snow = swe[elev];
+		const double temp_elev = simdSelect((elev >= firstThresh) & (snow > 1000.), threshTemp, dailyTemp - tempOffset[elev]);
+
+		// accumulation of snow and sublimation
+		const bool freeze = temp_elev <= snowFreezeTemp;
+		snow += simdSelect(freeze, prec, 0.);
+		const bool enough = snow >= PET;
+		evapo[elev] = simdSelect(freeze, simdSelect(enough, PET, snow), 0.);
+		snow = simdSelect(freeze, simdSelect(enough, snow - PET, 0.), snow);
+		rain[elev] = simdSelect(freeze, 0., prec); //Precipitation is rain, not snow
+
+		// melting of snow
+		const bool melting = temp_elev > snowMeltTemp;
+		const double snowmelt_elev = degreeDayFactor * (temp_elev - snowMeltTemp);
+		const double m = simdSelect(melting, simdSelect(snowmelt_elev > snow, snow, snowmelt_elev), 0.);
+		melt[elev] = m;
+		swe[elev] = snow - m; // not snow - degreeDayFactor * (...), which could become a fused multiply-add
+	}
+};
+
 //' @title snow storage interpolation
 //' @description snow storage is calculated in sub-grid scale (1min) and aggregated to 5min after each day/iteration
+//' @param ctx ModelContext of the model
 //' @param day day of simulation period as integer
 //' @param daily_prec_to_soil throughfall from canopy
 //' @param G_snow snow storage at 5min scale
@@ -18,95 +59,162 @@ using namespace std;
 //' @param thresh_elev helper - information of reference height,when there is unlimited snow accummulation (> 1000mm)
 //' @param dailyEffPrec effective precipitation to soil (throughfall + snow melt - fallen snow)
 //' @param dailySoilPET energy for PET which is left for soil
-//' @export
-// [[Rcpp::export]]
-void dailySnow(int day, const NumericVector daily_prec_to_soil, NumericVector G_snow, NumericMatrix G_snowWaterEquivalent,
-	NumericVector dailySnowMelt, NumericVector dailySnowEvapo, NumericVector thresh_elev, NumericVector dailyEffPrec,
-	NumericVector dailySoilPET){
+//' only active cells (snow or freezing temperature in a subgrid, see ctx.snowActiveCells) are simulated per subgrid,
+//' with ctx.simdLevel > 0 the subgrids of a cell are simulated at once (SnowBandKernel, same results)
+void dailySnow(ModelContext& ctx, int day, const NumericVector& daily_prec_to_soil, NumericVector& G_snow, NumericMatrix& G_snowWaterEquivalent,
+	NumericVector& dailySnowMelt, NumericVector& dailySnowEvapo, NumericVector& thresh_elev, NumericVector& dailyEffPrec,
+	NumericVector& dailySoilPET){
 	
 	//parameters to use
-	const int subgrids = G_Elevation.nrow();; //1st entry is mean elevation, rest is for subgrids
-	//const int cells = G_Elevation.ncol();
+	const int bands = ctx.nSnowBands; // subgrids (1st entry of G_Elevation is mean elevation)
 	
-	//variables to use
-	double snowmelt_elev; // snow melt in subgrid
-	double temp_elev;	// Temperature in subgrid
-	double daily_snow_to_soil_elev; //
+	SnowBandKernel kernel;
+	kernel.evapo = ctx.snowBandFlux.data();
+	kernel.rain = kernel.evapo + bands;
+	kernel.melt = kernel.rain + bands;
+	kernel.snowFreezeTemp = ctx.snowFreezeTemp;
+	kernel.snowMeltTemp = ctx.snowMeltTemp;
 
-	NumericVector dailyTemp = Temp(day,_); //getting Temperature for the day
-	
-	for (int cell = 0; cell < array_size; cell++){
+	// active cells: snow in one of the subgrids (snowCovered) or a subgrid below freezing temperature,
+	// in all other cells precipitation is rain and there is no snow to melt, so they are finished here
+	ctx.snowActiveCells.clear();
+	for (int cell = 0; cell < ctx.array_size; cell++){
+		if (ctx.snowCovered[cell] || !(ctx.Temp(day, cell) - ctx.snowMaxTempOffset[cell] > ctx.snowFreezeTemp)) {
+			ctx.snowActiveCells.push_back(cell);
+			continue;
+		}
+		double effPrec = dailyEffPrec[cell];
+		for (int elev = 0; elev < bands; elev++) {
+			effPrec += daily_prec_to_soil[cell]; // same sum as for the subgrids of an active cell
+		}
+		G_snow[cell] /= bands;
+		dailyEffPrec[cell] = effPrec / bands;
+		dailySnowMelt[cell] /= bands;
+		dailySnowEvapo[cell] /= bands;
+		dailySoilPET[cell] -= dailySnowEvapo[cell]; //reducing left evaporation energy
+	}
+
+	for (size_t k = 0; k < ctx.snowActiveCells.size(); k++){
+		
+		const int cell = ctx.snowActiveCells[k];
+		const double dailyTemp = ctx.Temp(day, cell); //getting Temperature for the day
+		double* swe = &G_snowWaterEquivalent(0, cell);
+		
+		double snowSum = G_snow[cell];
+		double effPrec = dailyEffPrec[cell];
+		double snowMelt = dailySnowMelt[cell];
+		double snowEvapo = dailySnowEvapo[cell];
+		bool covered = false;
 		
-		//loop for all subgrids in cells with elevation >0m. At the end of the loop, snow cover of
-		//all subgrids are added to the 0.5° Grid (G_Snow) again.
-		for (short elev = 1; elev < subgrids; elev++) {	//count the subgrids
+		if (ctx.simdLevel > 0) {
+			// checking special case to avoid unlimited snow accumulation on glaciers (see below),
+			// here the threshold elevation is found before all bands are simulated at once, in the same sequence as the scalar loop:
+			// a band with elevation 0 leaves thresh_elev at 0 (next band with SWE > 1000 mm sets it again),
+			// with a negative threshold elevation the threshold temperature is never used
+			int firstThresh = 0;
+			if (thresh_elev[cell] == 0.) {
+				firstThresh = bands;
+				for (int elev = 0; elev < bands; elev++) {
+					if (swe[elev] > 1000.) {
+						thresh_elev[cell] = ctx.G_Elevation(elev + 1, cell); // remember threshold elevation of cell
+						if (thresh_elev[cell] != 0.) {
+							firstThresh = elev + 1; // the threshold band itself keeps its own temperature
+							break;
+						}
+					}
+				}
+			}
+			kernel.firstThresh = (thresh_elev[cell] > 0.) ? firstThresh : bands;
 			
-			// elevation dependent temperature in one grid cell
-			// 0.6°C/100m after Semadeni-Davies (1997) and Dunn, Colohan (1999);
-			// The first row of G_ELEV_RANGE.UNF2 (G_Elevation[n][0]) contains mean elevation;
-			// actually I chould change G_ELEV_RANGE so there are at least 27 entries with mean elevation also for 0.5° (climate input resolution)
-			temp_elev = dailyTemp[cell] - ((G_Elevation(elev,cell) - G_Elevation(0, cell)) * 0.006);
+			kernel.tempOffset = &ctx.snowTempOffset[(size_t) cell * bands];
+			kernel.swe = swe;
+			kernel.dailyTemp = dailyTemp;
+			kernel.threshTemp = dailyTemp - ((thresh_elev[cell] - ctx.G_Elevation(0, cell)) * 0.006);
+			kernel.prec = daily_prec_to_soil[cell];
+			kernel.PET = dailySoilPET[cell];
+			kernel.degreeDayFactor = ctx.par.soil.degreeDayFactor[cell];
+			runVectorKernel(ctx.simdLevel, kernel, bands);
 			
-			// checking special case to avoid unlimited snow accumulation on glaciers
-			// if SWE is > 1000 mm --> 
-			if (G_snowWaterEquivalent(elev-1, cell) > 1000.) {
-
-				// define threshold elevation in cell
-				if (thresh_elev[cell] == 0.) {
-					// first elevation that has snowWaterEquivalent > 1000 is used as threshold elevation 
-					// because altitudes are written in increasing order this is the lowest sub scale grid where this case occurs
-					// actually I would suggest to use highest sub scale grid where this case does not occur!
-					thresh_elev[cell] = G_Elevation(elev, cell); // remember threshold elevation of cell
-				} else if (thresh_elev[cell] > 0.) { // cell above threshold elevation
-					temp_elev = dailyTemp[cell] - ((thresh_elev[cell] - G_Elevation(0, cell)) * 0.006); // all upper elevations get same temperature calculated with remebered elev
-				} 
+			// sum up the bands in the same order as the scalar code
+			for (int elev = 0; elev < bands; elev++) {
+				snowEvapo += kernel.evapo[elev];
+				effPrec += kernel.rain[elev];
+				snowMelt += kernel.melt[elev];
+				effPrec += kernel.melt[elev];
+				snowSum += swe[elev];
+				covered |= (swe[elev] != 0.);
 			}
+		} else {
+			const double* tempOffset = &ctx.snowTempOffset[(size_t) cell * bands];
 			
-			
-			// accumulation of snow and sublimation
-			if (temp_elev <= snowFreezeTemp) { //0.0°C
+			//loop for all subgrids in cells with elevation >0m. At the end of the loop, snow cover of
+			//all subgrids are added to the 0.5° Grid (G_Snow) again.
+			for (int elev = 0; elev < bands; elev++) {	//count the subgrids
+				
+				// elevation dependent temperature in one grid cell
+				// 0.6°C/100m after Semadeni-Davies (1997) and Dunn, Colohan (1999) (see initSnowBands())
+				double temp_elev = dailyTemp - tempOffset[elev];	// Temperature in subgrid
+				double snowmelt_elev; // snow melt in subgrid
+				
+				// checking special case to avoid unlimited snow accumulation on glaciers
+				// if SWE is > 1000 mm --> 
+				if (swe[elev] > 1000.) {
+
+					// define threshold elevation in cell
+					if (thresh_elev[cell] == 0.) {
+						// first elevation that has snowWaterEquivalent > 1000 is used as threshold elevation 
+						// because altitudes are written in increasing order this is the lowest sub scale grid where this case occurs
+						// actually I would suggest to use highest sub scale grid where this case does not occur!
+						thresh_elev[cell] = ctx.G_Elevation(elev + 1, cell); // remember threshold elevation of cell
+					} else if (thresh_elev[cell] > 0.) { // cell above threshold elevation
+						temp_elev = dailyTemp - ((thresh_elev[cell] - ctx.G_Elevation(0, cell)) * 0.006); // all upper elevations get same temperature calculated with remebered elev
+					} 
+				}
+				
+				// accumulation of snow and sublimation
+				if (temp_elev <= ctx.snowFreezeTemp) { //0.0°C
 
-				daily_snow_to_soil_elev = daily_prec_to_soil[cell];
-				G_snowWaterEquivalent(elev-1, cell) += daily_snow_to_soil_elev;	//value below canopy
+					swe[elev] += daily_prec_to_soil[cell];	//value below canopy
 
-				if (G_snowWaterEquivalent(elev-1, cell) >= dailySoilPET[cell]) {
-					G_snowWaterEquivalent(elev-1, cell) -= dailySoilPET[cell];
-					dailySnowEvapo[cell] += dailySoilPET[cell];
+					if (swe[elev] >= dailySoilPET[cell]) {
+						swe[elev] -= dailySoilPET[cell];
+						snowEvapo += dailySoilPET[cell];
+					} else {
+						snowEvapo += swe[elev];
+						swe[elev] = 0.;
+					}
 				} else {
-					dailySnowEvapo[cell] += G_snowWaterEquivalent(elev-1, cell);
-					G_snowWaterEquivalent(elev-1, cell) = 0.;
-				}
-			} else {
-				dailyEffPrec[cell] += daily_prec_to_soil[cell];} //Precipitation is rain, not snow
+					effPrec += daily_prec_to_soil[cell];} //Precipitation is rain, not snow
 
-			// melting of snow
-			if (temp_elev > snowMeltTemp) { //0.0°C
-				
-				snowmelt_elev = degreeDayFactor[cell] * (temp_elev - snowMeltTemp);
+				// melting of snow
+				if (temp_elev > ctx.snowMeltTemp) { //0.0°C
+					
+					snowmelt_elev = ctx.par.soil.degreeDayFactor[cell] * (temp_elev - ctx.snowMeltTemp);
 
-				if (snowmelt_elev > G_snowWaterEquivalent(elev-1, cell)) {
-					snowmelt_elev = G_snowWaterEquivalent(elev-1, cell);
-					G_snowWaterEquivalent(elev-1, cell) = 0.;
+					if (snowmelt_elev > swe[elev]) {
+						snowmelt_elev = swe[elev];
+						swe[elev] = 0.;
+					} else {
+						swe[elev] -= snowmelt_elev;
+					}
 				} else {
-					G_snowWaterEquivalent(elev-1, cell) -= snowmelt_elev;
+					snowmelt_elev = 0;
 				}
-			} else {
-				snowmelt_elev = 0;
-			}
-			
-			
-			dailySnowMelt[cell] += snowmelt_elev; //snow melt water is stored for potential output
-			dailyEffPrec[cell] += snowmelt_elev; // snow melt water is added to effective preiciptation to create run-off later
-			G_snow[cell] += G_snowWaterEquivalent(elev-1, cell);	// sum up all snow in subgrids to G_Snow
+				
+				snowMelt += snowmelt_elev; //snow melt water is stored for potential output
+				effPrec += snowmelt_elev; // snow melt water is added to effective preiciptation to create run-off later
+				snowSum += swe[elev];	// sum up all snow in subgrids to G_Snow
+				covered |= (swe[elev] != 0.);
 
-		} // end subgrids (for)
+			} // end subgrids (for)
+		}
 
-		G_snow[cell] /= (subgrids-1);
-		dailyEffPrec[cell] /= (subgrids-1);	// sum of all subgrids has to be divided by the number of land subgrids
-		dailySnowMelt[cell] /= (subgrids-1);	// within the cell (if only land-subgrids, value is 100).	
-		dailySnowEvapo[cell] /= (subgrids-1);
+		ctx.snowCovered[cell] = covered;
+		G_snow[cell] = snowSum / bands;
+		dailyEffPrec[cell] = effPrec / bands;	// sum of all subgrids has to be divided by the number of land subgrids
+		dailySnowMelt[cell] = snowMelt / bands;	// within the cell (if only land-subgrids, value is 100).	
+		dailySnowEvapo[cell] = snowEvapo / bands;
 		dailySoilPET[cell] -= dailySnowEvapo[cell]; //reducing left evaporation energy
 						
   } // end for loop cells
 } //end of snow calculations
-
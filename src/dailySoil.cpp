@@ -2,12 +2,103 @@
 #include <math.h>
 #include "initModel.h"
 #include "dailySoil.h"
+#include "VectorMath.h"
 
 using namespace Rcpp;
 using namespace std;
 
+/////////////////////////////////////////////// SOIL ///////////////////////////////////////////////////////////////////////////
+
+
+// soil water balance of one cell (original scalar code)
+static inline void dailySoilCell(ModelContext& ctx, int cell, const NumericVector& dailyEffPrec, const NumericVector& dailySoilPET, 
+		  const NumericVector& dailyCanopyEvapo, const NumericVector& dailySnowEvapo, 
+		  NumericVector& G_soilWaterContent, NumericVector& dailyAET, NumericVector& daily_runoff, NumericVector& soil_water_overflow){
+	
+	soil_water_overflow[cell] = 0;
+	dailyAET[cell] = 0;
+	//total_daily_runoff[cell] = 0;
+	
+	const double soil_saturation = G_soilWaterContent[cell] / ctx.par.soil.G_Smax[cell]; //[-]
+	daily_runoff[cell] = dailyEffPrec[cell] * pow(soil_saturation, ctx.par.soil.G_GAMMA_HBV[cell]); //das klappt nicht!
+	// this formula maybe produes NAN in the beginning of a simulation...
+	
+	//check wether max daily PET should be limited or not (see maxDailyPET_arid or maxDailyPET_humid):
+		//Actual evapotranspiration from the soil Ea [mm d-1] is computed as a function of potential evapotranspiration from the soil (Epot − Ec), 
+		// the actual soil water content in the effective root zone Ss [mm] and Ss,max: 
+		// -->  Epot,max is maximum daily evapotranspiration rate, set to 10 mmd-1 in humid areas and 20 mmd-1 in arid areas. (Eisner, 2015)
+		
+		//actually not sure why this rate is applied - possibly due to quite high evaporation rates in some areas because of inacuracy of the applied method to estimate PET
+	dailyAET[cell] = min(dailySoilPET[cell], (ctx.par.soil.maxDailyPET[cell] - dailyCanopyEvapo[cell] - dailySnowEvapo[cell]) * soil_saturation); //formula applied as described in Eisner 2015
+	
+
+	//water balance of the soil
+	G_soilWaterContent[cell] += dailyEffPrec[cell] - dailyAET[cell] - daily_runoff[cell];
+
+	if (G_soilWaterContent[cell] < 0.) {
+		// too much water has been taken out of the soil water storage --> correction of AET (and run off ?)
+		dailyAET[cell] += G_soilWaterContent[cell]; // G_soilWaterContent[n] is negative! THerefore +-
+		G_soilWaterContent[cell] = 0.; // correct soil water storage
+		soil_water_overflow[cell] = 0.;
+	} else if (G_soilWaterContent[cell] > ctx.par.soil.G_Smax[cell]) { //this is a really ugly solution for overflow!
+		soil_water_overflow[cell] = G_soilWaterContent[cell] - ctx.par.soil.G_Smax[cell];
+		G_soilWaterContent[cell] = ctx.par.soil.G_Smax[cell];
+	} else {
+		soil_water_overflow[cell] = 0.;
+	}
+	
+	
+	//corecction factor is applied afterwards!
+	//daily_runoff[cell] *= G_CORR_FACTOR[cell];
+	//soil_water_overflow[cell] *= G_CORR_FACTOR[cell];
+	//total_daily_runoff[cell] = (daily_runoff[cell] + immediate_runoff[cell] + soil_water_overflow[cell]) * G_CORR_FACTOR[cell];;
+	
+	// dailyCellLandAET is a corrected actual total evaporation (canopy, snow and soil)
+	// it is consistent with cell-corrected runoff
+	//dailyCellLandAET[n] = landStorageChangeSum * (G_cellCorrFact[n] - 1.0)
+	//		- dailyPrec * (G_cellCorrFact[n] - 1.0)
+	//		+ (dailyAET + dailyCanopyEvapo + dailySnowEvapo) * G_cellCorrFact[n];
+}
+
+// one cell of dailySoil() for runVectorKernel(): same as dailySoilCell() without branches
+// cells where pow() can not be replaced by simdPow() are not changed and marked in fallback
+struct SoilKernel {
+	const param_t* G_Smax;
+	const param_t* G_GAMMA_HBV;
+	const param_t* maxDailyPET;
+	const double* dailyEffPrec;
+	const double* dailySoilPET;
+	const double* dailyCanopyEvapo;
+	const double* dailySnowEvapo;
+	double* G_soilWaterContent;
+	double* dailyAET;
+	double* daily_runoff;
+	double* soil_water_overflow;
+	char* fallback;
+
+	VECTOR_INLINE void operator()(int cell){
+		const double Smax = G_Smax[cell];
+		const double soil_saturation = G_soilWaterContent[cell] / Smax; //[-]
+		const bool valid = simdPowValid(soil_saturation);
+		const double runoff = dailyEffPrec[cell] * simdPow(soil_saturation, G_GAMMA_HBV[cell]);
+		const double AETmax = (maxDailyPET[cell] - dailyCanopyEvapo[cell] - dailySnowEvapo[cell]) * soil_saturation;
+		const double AET = simdSelect(AETmax < dailySoilPET[cell], AETmax, dailySoilPET[cell]); // min()
+
+		const double content = G_soilWaterContent[cell] + (dailyEffPrec[cell] - AET - runoff);
+		const bool empty = content < 0.;
+		const bool full = !empty & (content > Smax);
+
+		dailyAET[cell] = simdSelect(valid, simdSelect(empty, AET + content, AET), dailyAET[cell]);
+		daily_runoff[cell] = simdSelect(valid, runoff, daily_runoff[cell]);
+		soil_water_overflow[cell] = simdSelect(valid & full, content - Smax, simdSelect(valid, 0., soil_water_overflow[cell]));
+		G_soilWaterContent[cell] = simdSelect(valid, simdSelect(empty, 0., simdSelect(full, Smax, content)), G_soilWaterContent[cell]);
+		fallback[cell] = !valid;
+	}
+};
+
 //' @title soil storage implementation
 //' @description core of the modle where run-off generation processes are takes part and calibration parameter gamma is implemented
+//' @param ctx ModelContext of the model
 //' @param dailyEffPrec effective precipitation to soil (throughfall + snow melt - fallen snow)
 //' @param immediate_runoff immediate run-off that was build over sealed area and does not go into soil storage
 //' @param dailySoilPET energy which is left for evapotranspration from soil
@@ -18,62 +109,29 @@ using namespace std;
 //' @param daily_runoff created run-off in soil storage (is later on split into fast and slow component)
 //' @param soil_water_overflow overflow of soil storage which contributes directly to the fast run-off component later
 //' @export
-
-/////////////////////////////////////////////// SOIL ///////////////////////////////////////////////////////////////////////////
-
-
-void dailySoil(const NumericVector dailyEffPrec, const NumericVector immediate_runoff, const NumericVector dailySoilPET, 
-		  const NumericVector dailyCanopyEvapo, const NumericVector dailySnowEvapo, 
-		  NumericVector G_soilWaterContent, NumericVector dailyAET, NumericVector daily_runoff, NumericVector soil_water_overflow){ 
+void dailySoil(ModelContext& ctx, const NumericVector& dailyEffPrec, const NumericVector& immediate_runoff, const NumericVector& dailySoilPET, 
+		  const NumericVector& dailyCanopyEvapo, const NumericVector& dailySnowEvapo, 
+		  NumericVector& G_soilWaterContent, NumericVector& dailyAET, NumericVector& daily_runoff, NumericVector& soil_water_overflow){ 
 	
 	//const int cells = maxDailyPET.length();
-	double soil_saturation;
-		
-	for (int cell = 0; cell < array_size; cell++){
-		
-		soil_water_overflow[cell] = 0;
-		dailyAET[cell] = 0;
-		//total_daily_runoff[cell] = 0;
-		
-		soil_saturation = G_soilWaterContent[cell] / G_Smax[cell]; //[-]
-		daily_runoff[cell] = dailyEffPrec[cell] * pow(soil_saturation, G_GAMMA_HBV[cell]); //das klappt nicht!
-		// this formula maybe produes NAN in the beginning of a simulation...
-		
-		//check wether max daily PET should be limited or not (see maxDailyPET_arid or maxDailyPET_humid):
-			//Actual evapotranspiration from the soil Ea [mm d-1] is computed as a function of potential evapotranspiration from the soil (Epot − Ec), 
-			// the actual soil water content in the effective root zone Ss [mm] and Ss,max: 
-			// -->  Epot,max is maximum daily evapotranspiration rate, set to 10 mmd-1 in humid areas and 20 mmd-1 in arid areas. (Eisner, 2015)
-			
-			//actually not sure why this rate is applied - possibly due to quite high evaporation rates in some areas because of inacuracy of the applied method to estimate PET
-		dailyAET[cell] = min(dailySoilPET[cell], (maxDailyPET[cell] - dailyCanopyEvapo[cell] - dailySnowEvapo[cell]) * soil_saturation); //formula applied as described in Eisner 2015
-		
-
-		//water balance of the soil
-		G_soilWaterContent[cell] += dailyEffPrec[cell] - dailyAET[cell] - daily_runoff[cell];
-
-		if (G_soilWaterContent[cell] < 0.) {
-			// too much water has been taken out of the soil water storage --> correction of AET (and run off ?)
-			dailyAET[cell] += G_soilWaterContent[cell]; // G_soilWaterContent[n] is negative! THerefore +-
-			G_soilWaterContent[cell] = 0.; // correct soil water storage
-			soil_water_overflow[cell] = 0.;
-		} else if (G_soilWaterContent[cell] > G_Smax[cell]) { //this is a really ugly solution for overflow!
-			soil_water_overflow[cell] = G_soilWaterContent[cell] - G_Smax[cell];
-			G_soilWaterContent[cell] = G_Smax[cell];
-		} else {
-			soil_water_overflow[cell] = 0.;
+	
+	if (ctx.simdLevel > 0) {
+		SoilKernel kernel = {ctx.par.soil.G_Smax, ctx.par.soil.G_GAMMA_HBV, ctx.par.soil.maxDailyPET,
+						dailyEffPrec.begin(), dailySoilPET.begin(), dailyCanopyEvapo.begin(), dailySnowEvapo.begin(),
+						G_soilWaterContent.begin(), dailyAET.begin(), daily_runoff.begin(), soil_water_overflow.begin(), ctx.vectorFallback.data()};
+		runVectorKernel(ctx.simdLevel, kernel, ctx.array_size);
+		for (int cell = 0; cell < ctx.array_size; cell++){
+			if (ctx.vectorFallback[cell]) { // e.g. G_Smax = 0
+				dailySoilCell(ctx, cell, dailyEffPrec, dailySoilPET, dailyCanopyEvapo, dailySnowEvapo,
+							G_soilWaterContent, dailyAET, daily_runoff, soil_water_overflow);
+			}
 		}
-		
-		
-		//corecction factor is applied afterwards!
-		//daily_runoff[cell] *= G_CORR_FACTOR[cell];
-		//soil_water_overflow[cell] *= G_CORR_FACTOR[cell];
-		//total_daily_runoff[cell] = (daily_runoff[cell] + immediate_runoff[cell] + soil_water_overflow[cell]) * G_CORR_FACTOR[cell];;
-		
-		// dailyCellLandAET is a corrected actual total evaporation (canopy, snow and soil)
-		// it is consistent with cell-corrected runoff
-		//dailyCellLandAET[n] = landStorageChangeSum * (G_cellCorrFact[n] - 1.0)
-		//		- dailyPrec * (G_cellCorrFact[n] - 1.0)
-		//		+ (dailyAET + dailyCanopyEvapo + dailySnowEvapo) * G_cellCorrFact[n];
+		return;
+	}
+	
+	for (int cell = 0; cell < ctx.array_size; cell++){
+		dailySoilCell(ctx, cell, dailyEffPrec, dailySoilPET, dailyCanopyEvapo, dailySnowEvapo,
+					G_soilWaterContent, dailyAET, daily_runoff, soil_water_overflow);
 	}
 	//List L = List::create(G_soilWaterContent, dailyAET, daily_runoff, soil_water_overflow);
 	//return(L);
@@ -4,14 +4,15 @@
 #include "initModel.h"
 #include "dailySplitRunOff.h"
 #include "WaterUseConsumGW.h"
+#include "VectorMath.h"
 
 using namespace Rcpp;
 using namespace std;
 
 //' @title Splitting run-off in slow and fast component
 //' @description splitting run-off in fast (surface) and slow (groundwater) component using soil information
+//' @param ctx ModelContext of the model
 //' @param day day of simulation period as integer
-//' @param SimDate date of day of simulation period as integer
 //' @param daily_runoff created run-off in soil storage which is split into fast and slow component
 //' @param soil_water_overflow verflow of soil storage which contributes directly to the fast run-off component
 //' @param immediate_runoff immediate run-off that was build over sealed area which contributes directly to the fast run-off component
@@ -22,42 +23,99 @@ using namespace std;
 //' @param dailyUse information about water uses 
 //' @export
 
-void dailySplitRunOff(int day, Date SimDate, const NumericVector daily_runoff, const NumericVector soil_water_overflow, const NumericVector immediate_runoff,
-				NumericVector daily_gw_recharge, NumericVector G_groundwater, NumericVector G_dailyLocalSurfaceRunoff, 
-				NumericVector G_dailyLocalGWRunoff,NumericVector G_dailyUseGW, const NumericMatrix dailyUse){ 
+// one cell of dailySplitRunOff() for runVectorKernel(): same as the loop below (including WaterUseConsumGW()) without branches
+struct SplitRunOffKernel {
+	const double* Prec; // day of Prec
+	const double* dailyUse; // first row = GW (stride nrowUse)
+	size_t nrowUse;
+	bool useSplitfactor; // splitType != 0
+	double pcrit;
+	double k_g;
+	SoilParameters par;
+	const param_t* GAREA;
+	const param_t* landfrac;
+	const double* daily_runoff;
+	const double* soil_water_overflow;
+	const double* immediate_runoff;
+	double* daily_gw_recharge;
+	double* G_groundwater;
+	double* G_dailyLocalSurfaceRunoff;
+	double* G_dailyLocalGWRunoff;
+	double* G_dailyUseGW;
+
+	VECTOR_INLINE void operator()(int cell){
+		const double dailyPrec = Prec[cell];
+
+		//======================== Groundwater =======================================
+		const double RGmax = par.G_RG_max[cell]/100.;
+		const double RG = par.G_gwFactor[cell] * daily_runoff[cell];
+		const double RGmaxSplit = par.G_RG_max[cell]/100.*par.Splitfactor[cell];
+		const double RGsplit = par.G_gwFactor[cell]*par.Splitfactor[cell]*daily_runoff[cell];
+		const double recharge = simdSelect(useSplitfactor, simdSelect(RGsplit < RGmaxSplit, RGsplit, RGmaxSplit), simdSelect(RG < RGmax, RG, RGmax)); // min()
+		//checking special conditions for arid regions
+		const bool arid = (par.G_ARID_HUMID[cell] == 2) & (par.G_TEXTURE[cell] < 21) & (dailyPrec < pcrit);
+		daily_gw_recharge[cell] = simdSelect(arid, 0., recharge);
+
+		double groundwater = G_groundwater[cell] + daily_gw_recharge[cell]; //mm
+		const double GWrunoff = k_g * groundwater;
+		G_dailyLocalGWRunoff[cell] = simdSelect(GWrunoff < 0., 0., GWrunoff); // max()
+		groundwater -= G_dailyLocalGWRunoff[cell]; //mm
+
+		//Extract/Add Net Abstraction of Groundwater from GW storage (see WaterUseConsumGW())
+		const bool land = (GAREA[cell] > 0) & (landfrac[cell] > 0);
+		G_dailyUseGW[cell] = simdSelect(land, dailyUse[cell * nrowUse] / (GAREA[cell] * landfrac[cell]), 0.0);
+		G_groundwater[cell] = simdSelect(land, groundwater - G_dailyUseGW[cell], groundwater);
+
+		// ===================== Surface run-off =====================================
+		G_dailyLocalSurfaceRunoff[cell] = immediate_runoff[cell] + soil_water_overflow[cell] + (daily_runoff[cell] - daily_gw_recharge[cell]);
+	}
+};
+
+void dailySplitRunOff(ModelContext& ctx, int day, const NumericVector& daily_runoff, const NumericVector& soil_water_overflow, const NumericVector& immediate_runoff,
+				NumericVector& daily_gw_recharge, NumericVector& G_groundwater, NumericVector& G_dailyLocalSurfaceRunoff, 
+				NumericVector& G_dailyLocalGWRunoff,NumericVector& G_dailyUseGW, const WaterUseDay& dailyUse){ 
 	
-	const NumericVector dailyPrec = Prec(day,_); 
 	double dailyUseGW=0;
-	//int year = SimDate.getYear();
-	//int month = SimDate.getMonth();
 	
-	for (int cell = 0; cell < array_size; cell++){
+	if (ctx.simdLevel > 0) {
+		SplitRunOffKernel kernel = {ctx.Prec.row(day), dailyUse.begin(), (size_t) dailyUse.nrow(),
+								 ctx.splitType != 0, ctx.pcrit, ctx.k_g, ctx.par.soil, ctx.par.wb.GAREA, ctx.par.wb.landfrac,
+								 daily_runoff.begin(), soil_water_overflow.begin(), immediate_runoff.begin(),
+								 daily_gw_recharge.begin(), G_groundwater.begin(), G_dailyLocalSurfaceRunoff.begin(),
+								 G_dailyLocalGWRunoff.begin(), G_dailyUseGW.begin()};
+		runVectorKernel(ctx.simdLevel, kernel, ctx.array_size);
+		return;
+	}
+	
+	for (int cell = 0; cell < ctx.array_size; cell++){
+		
+		const double dailyPrec = ctx.Prec(day, cell);
 		
-		if (splitType == 0) {
+		if (ctx.splitType == 0) {
 			//======================== Groundwater =======================================
-			daily_gw_recharge[cell] = min(G_RG_max[cell]/100., G_gwFactor[cell] * daily_runoff[cell]); //geting RG for cell and day 
+			daily_gw_recharge[cell] = min(ctx.par.soil.G_RG_max[cell]/100., ctx.par.soil.G_gwFactor[cell] * daily_runoff[cell]); //geting RG for cell and day 
 			//checking special conditions for arid regions
-			if ( (G_ARID_HUMID[cell] == 2) & (G_TEXTURE[cell] < 21) & (dailyPrec[cell] < pcrit)){
+			if ( (ctx.par.soil.G_ARID_HUMID[cell] == 2) & (ctx.par.soil.G_TEXTURE[cell] < 21) & (dailyPrec < ctx.pcrit)){
 				daily_gw_recharge[cell] = 0.;      //reducing gw-recharge in arid regions with medium to coarse texture, when there is no heavy rain
 			}
 			
 		} else {
-			daily_gw_recharge[cell] = min(G_RG_max[cell]/100.*Splitfactor[cell], G_gwFactor[cell]*Splitfactor[cell]*daily_runoff[cell]); //min(G_RG_max[cell]/100., Splitfactor[cell]*daily_runoff[cell]); //
+			daily_gw_recharge[cell] = min(ctx.par.soil.G_RG_max[cell]/100.*ctx.par.soil.Splitfactor[cell], ctx.par.soil.G_gwFactor[cell]*ctx.par.soil.Splitfactor[cell]*daily_runoff[cell]); //min(G_RG_max[cell]/100., Splitfactor[cell]*daily_runoff[cell]); //
 			//checking special conditions for arid regions
-			if ( (G_ARID_HUMID[cell] == 2) & (G_TEXTURE[cell] < 21) & (dailyPrec[cell] < pcrit)){
+			if ( (ctx.par.soil.G_ARID_HUMID[cell] == 2) & (ctx.par.soil.G_TEXTURE[cell] < 21) & (dailyPrec < ctx.pcrit)){
 				daily_gw_recharge[cell] = 0.;      //reducing gw-recharge in arid regions with medium to coarse texture, when there is no heavy rain
 			}
 		}
 		
 		//grodunwater routing - would be better with els equation so there is not such a discontinuity
 		G_groundwater[cell] += daily_gw_recharge[cell]; //mm
-		G_dailyLocalGWRunoff[cell] = max(k_g * G_groundwater[cell], 0.); // so when there is negative groundwater storage than there is no run-off[mm]
+		G_dailyLocalGWRunoff[cell] = max(ctx.k_g * G_groundwater[cell], 0.); // so when there is negative groundwater storage than there is no run-off[mm]
 		G_groundwater[cell] -= G_dailyLocalGWRunoff[cell]; //mm
 		// Actual storage Sb is allowed to fall below 0 as a consequence of an imbalance between abstractions
 		//and long-term recharge to mimic the process of groundwater overuse and depletion. (Eisner, 2015)
 		
 		//Extract/Add Net Abstraction of Groundwater from GW storage
-		dailyUseGW = WaterUseConsumGW(cell, G_groundwater, dailyUse) ; //mm --> does not work when dailyUse = 0
+		dailyUseGW = WaterUseConsumGW(ctx, cell, G_groundwater, dailyUse) ; //mm --> does not work when dailyUse = 0
 		G_dailyUseGW[cell] = dailyUseGW;
 		
 		// ===================== Surface run-off =====================================
@@ -1,113 +1,29 @@
 #include <Rcpp.h>
+#include <algorithm>
 #include "initModel.h"
+#include "ModelTools.h"
+#include "VectorMath.h"
 
 using namespace Rcpp;
 using namespace std;
 
-// Declaration of global constant variables that do not change in the whole simulation (static variables)
+// Definition of variables that do not change in the whole simulation (static variables) in the ModelContext
 // this makes a shallow copy, with the R object underlying
 // when the object do not change there is not much additional storage needed
-// because the object are referred to as "const" they can't change in the whole script! --> I think everything is fine
-// ATTENTION: redefinition of object name is possible, so when list is redefined than it is actually possible to change objects }
 
 
-//SETTINGS
-int waterUseType;
-int flowVelocityType;
-int GapYearType;
-int WaterUseAllocationType;
-int ReservoirType;
-int splitType;
-int calcLong;
-int useSystemVals;
-
-//CONSTANT FILES
-
-String SystemValues;
-int id;
-
-NumericMatrix Temp;
-NumericMatrix Rs;
-NumericMatrix Rl;
-NumericMatrix Prec; //WaterContent at the end of forstep
-int cor_row;
-NumericMatrix G_Elevation; //elevation of grid and subgrids
-NumericMatrix NeighbouringCells;
-
-IntegerVector GR;
-
-NumericMatrix Info_GW;
-NumericMatrix Info_SW;
-NumericMatrix Info_TF;
-NumericVector YearlyMeanDemand;
-
-NumericVector LAI_max;
-NumericVector GLCT;
-NumericVector initDays;
-NumericVector LAI_min;
-NumericMatrix dailyLaiAll; //Maximal Interception Storage
-
-NumericVector albedo;
-NumericVector albedoSnow;
-NumericVector emissivity;
-NumericVector alphaPT;
-NumericVector degreeDayFactor;
-NumericVector GBUILTUP;
-NumericVector G_GAMMA_HBV; //calibrated gamma value
-NumericVector maxDailyPET; ////precipitation + snow melt that comes to soil
-NumericVector G_Smax ; //size of soil layer/storage
-IntegerVector G_ARID_HUMID;
-NumericVector G_TEXTURE;
-NumericVector G_RG_max;
-NumericVector G_gwFactor;
-NumericVector GAREA;
-NumericVector landfrac;
-NumericVector G_ALLOC_COEFF;
-IntegerVector G_LOCLAK; // % of cell that belongs to local lake
-IntegerVector G_LOCWET; // % of cell that belongs to local wetland
-IntegerVector G_GLOLAK; // % of cell that belongs to global lake (including resevroirs at the moment)
-IntegerVector G_GLOWET; // % of cell that belongs to global wetland
-NumericVector G_RESAREA; // km² reservoir area defined in outlet cell of reservoirs
-NumericVector G_LAKAREA; // km² global lake area defined in outlet cell of global lake
-NumericVector G_STORAGE_CAPACITY;
-NumericVector G_MEAN_INFLOW;
-IntegerVector G_START_MONTH;
-IntegerVector G_RES_TYPE;
-IntegerVector routeOrder;
-IntegerVector outflowOrder; // obtained from routing input, modified
-
-NumericVector G_riverLength;
-NumericVector G_BANKFULL;
-NumericVector G_riverSlope;
-NumericVector G_riverRoughness;
-
-NumericVector Splitfactor;
-
-double maxCanopyStoragePerLAI; // 0.3 mm
-double canopyEvapoExp; // 0.6666667 [-]
-int array_size; //
-double snowFreezeTemp; // 0°C
-double snowMeltTemp;  // 0
-double runoffFracBuiltUp; // 0.5
-double  pcrit;
-double  k_g;
-double lakeDepth; // 0.005 km --> 5000 mm
-double lakeOutflowExp; // 1.5 [-]
-double wetlandDepth; // 0.002 km --> 2000 mm
-double wetlOutflowExp; // 2.5 [-]
-double evapoReductionExp; // 3.32193
-double evapoReductionExpReservoir; // 2.81383
-int glo_storageFactor;
-int loc_storageFactor;
-int reservoir_dsc = 20; //downstream cells that are considered for water use of reservoir (for 5min always the same)
-double defaultRiverVelocity; // = 86.4;	// [km/d] = 1 m/s
-
 //' @title Declaration of Settings from R Module
-//' @description translates R Settings to global rcpp Settings
+//' @description checks R Settings (the Settings are used for a model with initModelContext() or runModel())
 //' @param Settings Settings defined as IntegerVector
 //' @export
 // [[Rcpp::export]]
 void defSettings(NumericVector Settings){
+	ModelContext ctx;
+	defSettings(ctx, Settings);
+}
+
+// translates R Settings to rcpp Settings of the ModelContext
+void defSettings(ModelContext& ctx, NumericVector Settings){
 
 	// check for correct settings input
 	if (Settings.size() != 8)
@@ -118,9 +34,9 @@ void defSettings(NumericVector Settings){
 	{
 		stop("WaterUseType should be 0, 1 or 2");
 	}
-	if (Settings[1] != 0 && Settings[1] != 1 && Settings[1] != 2)
+	if (Settings[1] != 0 && Settings[1] != 1 && Settings[1] != 2 && Settings[1] != 3)
 	{
-		stop("WaterUseAllocationType should be 0, 1 or 2");
+		stop("WaterUseAllocationType should be 0, 1, 2 or 3");
 	}
 	if (Settings[2] != 0 && Settings[2] != 1)
 	{
@@ -147,75 +63,70 @@ void defSettings(NumericVector Settings){
 		stop("useSystemVals should be 0, 1, 2 or 3");
 	}
 
-	waterUseType = Settings[0];
-	WaterUseAllocationType = Settings[1];
-	flowVelocityType = Settings[2];
-	GapYearType = Settings[3];
-	ReservoirType = Settings[4];
-	splitType = Settings[5];
-	calcLong = Settings[6];
-	useSystemVals = Settings[7];
+	ctx.waterUseType = Settings[0];
+	ctx.WaterUseAllocationType = Settings[1];
+	ctx.flowVelocityType = Settings[2];
+	ctx.GapYearType = Settings[3];
+	ctx.ReservoirType = Settings[4];
+	ctx.splitType = Settings[5];
+	ctx.calcLong = Settings[6];
+	ctx.useSystemVals = Settings[7];
 }
 
-//' @title detLAIdaily
-//' @description Definition of interception storage size
-//' @param LAI_min minimal interception storage in mm from LAI_info
-//' @param LAI_max maximal interception storage in mm from LAI_info
-//' @param initDays needed days to start growing season in d from LAI_info
-//' @param Temp Temperature in °C (Matrix)
-//' @param Prec Precipitation in mm (Matrix)
-//' @param aridType arid or humid tyoe definition for cells, obtained from G_ARID_HUMID.UNF
-//' @param GLCT Landcover information
-//' @return Matrix with interception storage in mm (rows=days, cols=cells)
-//' @export
-
-NumericMatrix getLAIdaily(NumericVector LAI_min, NumericVector LAI_max, NumericVector initDays,
-						const NumericMatrix Temp, const NumericMatrix Prec, const IntegerVector aridType, const NumericVector GLCT){
+// definition of interception storage size: the LAI phenology of all cells (ctx.dailyLai) is advanced to day,
+// the state of every cell (PrecSum, GrowingStatus, days_since_start) is kept in the ModelContext, so no matrix with all days is needed;
+// days that are not simulated (e.g. 29.02. with GapYearType 1) are advanced as well, if day is before the last day (start of
+// a warm-up year or of the simulation period) the phenology starts again at the first day -> same LAI as the former matrix of getLAIdaily()
+// (uses LAI_min, LAI_max, initDays, GLCT, G_ARID_HUMID, Temp and Prec of ctx, day is the day of the simulation period)
+void updateLAIdaily(ModelContext& ctx, int day){
   //Ths function uses the model function as it is implemented iin WG3.1
 
-  int nrow = Temp.nrow();
-  int ncol = Temp.ncol();
-
-  NumericMatrix dailyLAI (nrow, ncol);
-  IntegerMatrix growingSeason (nrow, ncol);
+  if (day == ctx.laiDay) {
+	return;
+  }
+  if ((day < ctx.laiDay) || (ctx.laiDay < 0)) {
+	//for each cell everything is set to zero at the beginning of evaluation
+	fill(ctx.laiPrecSum.begin(), ctx.laiPrecSum.end(), 0.);
+	fill(ctx.laiGrowingStatus.begin(), ctx.laiGrowingStatus.end(), 0);
+	fill(ctx.laiDaysSinceStart.begin(), ctx.laiDaysSinceStart.end(), 0);
+	ctx.laiDay = -1;
+  }
 
   const double Tgrenz = 8.0; //as in model lai.cpp ll. 169
   const double PrecSumgrenz = 40;
 
 	//this is the original model code implemented, however the output seems to be quite weird..
-  for (int col = 0; col < ncol; col++){ //iterating through cells
-	//for each cell everything is set to zero at the beginning of evaluation
-	double PrecSum = 0;
-	int GrowingStatus = 0;
-	int days_since_start = 0;
+  for (int row = ctx.laiDay + 1; row <= day; row++){ //iterating through days
+	for (int col = 0; col < ctx.array_size; col++){ //iterating through cells
+		double& PrecSum = ctx.laiPrecSum[col];
+		int& GrowingStatus = ctx.laiGrowingStatus[col];
+		int& days_since_start = ctx.laiDaysSinceStart[col];
 
-	//iterating through days
-	for (int row = 0; row < nrow; row++){
-		if (Temp(row, col) > Tgrenz){ //case 1
+		if (ctx.Temp(row, col) > Tgrenz){ //case 1
 			if (GrowingStatus == 0) { // vegetation is not grown yet...
-				if (days_since_start >= initDays[col]){ // ...but initial days of growing season have been reached
+				if (days_since_start >= ctx.initDays[col]){ // ...but initial days of growing season have been reached
 					days_since_start++;
-					PrecSum += Prec(row,col);
+					PrecSum += ctx.Prec(row,col);
 					if(PrecSum > PrecSumgrenz ){ // threshold of min precipitation has been met and growing season can start
-						if (days_since_start >= initDays[col] + 30){ // full vegetation development has been reached and status will switch
-							days_since_start = initDays[col] + 30;
+						if (days_since_start >= ctx.initDays[col] + 30){ // full vegetation development has been reached and status will switch
+							days_since_start = ctx.initDays[col] + 30;
 							GrowingStatus = 1;
 						}
 						// return either the LAI in sprout or the max LAI-value
-						dailyLAI(row,col) = (LAI_min[col] + (LAI_max[col] - LAI_min[col]) * (days_since_start - initDays[col]) / 30.);
+						ctx.dailyLai[col] = (ctx.LAI_min[col] + (ctx.LAI_max[col] - ctx.LAI_min[col]) * (days_since_start - ctx.initDays[col]) / 30.);
 					} else { // sum of precipitation is not high enough to start growing season
-						days_since_start = initDays[col];
-						dailyLAI(row,col) = (LAI_min[col]);
+						days_since_start = ctx.initDays[col];
+						ctx.dailyLai[col] = (ctx.LAI_min[col]);
 					}
 				} else { // initial days of growing season have not been reached yet
 					days_since_start++;
-					PrecSum += Prec(row,col);
-					dailyLAI(row,col) = (LAI_min[col]);
+					PrecSum += ctx.Prec(row,col);
+					ctx.dailyLai[col] = (ctx.LAI_min[col]);
 				}
 			} else{// vegetation is already fully grown...
 				if (days_since_start <= 30) { // ...and we are in phase of senescence
 					days_since_start--;
-					if (GLCT[col] <= 2){ // if land_cover_type is '1' or '2' we have ervergreen plants and LAI will never clompletely degrade JK: not sure why this is done because LAImin is quite high for these plants
+					if (ctx.GLCT[col] <= 2){ // if land_cover_type is '1' or '2' we have ervergreen plants and LAI will never clompletely degrade JK: not sure why this is done because LAImin is quite high for these plants
 						GrowingStatus = 0; // therefore status will switch at once
 					}
 					if (days_since_start <= 0){ // LAI is completely degraded to min LAI and status will switch
@@ -223,34 +134,34 @@ NumericMatrix getLAIdaily(NumericVector LAI_min, NumericVector LAI_max, NumericV
 						GrowingStatus = 0;
 						PrecSum = 0.;
 					}
-					dailyLAI(row,col) = (LAI_max[col] - (LAI_max[col] - LAI_min[col]) * (30 - days_since_start) / 30.);
+					ctx.dailyLai[col] = (ctx.LAI_max[col] - (ctx.LAI_max[col] - ctx.LAI_min[col]) * (30 - days_since_start) / 30.);
 				} else { // initial days for senescence phase have not been reached yet and we have growing conditions (again)
-					if ( (aridType[col] != 1) & (Prec(row,col)<0.5) ){ // in arid regions we have no growing conditions if there is no rain
+					if ( (ctx.par.rad.G_ARID_HUMID[col] != 1) & (ctx.Prec(row,col)<0.5) ){ // in arid regions we have no growing conditions if there is no rain
 						days_since_start--;
 					} else {// if conditions for LAI reduction should happen day after day, use this  equation (reset for initial days)
-						days_since_start = 30 + initDays[col];
+						days_since_start = 30 + ctx.initDays[col];
 					}
-					dailyLAI(row,col) = (LAI_max[col]);
+					ctx.dailyLai[col] = (ctx.LAI_max[col]);
 				}
 			}
 		} else { //case 2
 			if (GrowingStatus == 0) { // vegetation is not fully grown yet
-				if (days_since_start > initDays[col]){ // initial days of growing season have been reached and plants will grow anyway
+				if (days_since_start > ctx.initDays[col]){ // initial days of growing season have been reached and plants will grow anyway
 					(days_since_start)++;
-					(PrecSum) += Prec(row,col);
+					(PrecSum) += ctx.Prec(row,col);
 					if(PrecSum > PrecSumgrenz){ // threshold of min precipitation has been met and growing season can start
-						if (days_since_start >= initDays[col] + 30){
-							days_since_start = initDays[col] + 30;
+						if (days_since_start >= ctx.initDays[col] + 30){
+							days_since_start = ctx.initDays[col] + 30;
 							GrowingStatus = 1;
 						}
-						dailyLAI(row,col) = (LAI_min[col] + (LAI_max[col] - LAI_min[col]) * (days_since_start - initDays[col]) / 30.);
+						ctx.dailyLai[col] = (ctx.LAI_min[col] + (ctx.LAI_max[col] - ctx.LAI_min[col]) * (days_since_start - ctx.initDays[col]) / 30.);
 					} else { // sum of precipitation is not high enough to start growing season
-						days_since_start = initDays[col];
-						dailyLAI(row,col) = (LAI_min[col]);
+						days_since_start = ctx.initDays[col];
+						ctx.dailyLai[col] = (ctx.LAI_min[col]);
 					}
 				} else { // no growing season
-					(PrecSum) += Prec(row,col);
-					dailyLAI(row,col) = (LAI_min[col]);
+					(PrecSum) += ctx.Prec(row,col);
+					ctx.dailyLai[col] = (ctx.LAI_min[col]);
 				}
 			} else { // we are in growing season but lai will be reduced now
 				if (days_since_start <= 30) {
@@ -260,105 +171,104 @@ NumericMatrix getLAIdaily(NumericVector LAI_min, NumericVector LAI_max, NumericV
 						GrowingStatus = 0;
 						PrecSum = 0.;
 					}
-					dailyLAI(row,col) = (LAI_max[col] - (LAI_max[col] - LAI_min[col]) * (30 - days_since_start) / 30.);
+					ctx.dailyLai[col] = (ctx.LAI_max[col] - (ctx.LAI_max[col] - ctx.LAI_min[col]) * (30 - days_since_start) / 30.);
 				} else { // we are in growing season but the inital days for lai degrading have not been met
 					(days_since_start)--;
-					dailyLAI(row,col) = (LAI_max[col]);
+					ctx.dailyLai[col] = (ctx.LAI_max[col]);
 				}
 			}
 		}
 	}
   }
-  return(dailyLAI);
+  ctx.laiDay = day;
 }
 
 
-//' @title initModel
-//' @description Sets passed List as global model input
-//' @param ListConst that is defined in R
-//' @export
-void initModel(List ListConst){
-
-	SystemValues = as<String>(ListConst["SystemValuesPath"]);
-	id = as<int>(ListConst["id"]);
+// sets the List defined in R (ListConst) as model input of the ModelContext
+void initModel(ModelContext& ctx, List ListConst){
 
-	Temp = as<NumericMatrix>(ListConst["temp"]);
-	Rs = as<NumericMatrix>(ListConst["shortwave"]);
-	Rl = as<NumericMatrix>(ListConst["longwave"]);
-	Prec = as<NumericMatrix>(ListConst["prec"]);
-	GR = as<IntegerVector>(ListConst["GR"]);
+	ctx.ListConst = ListConst;
+	ctx.SystemValues = as<String>(ListConst["SystemValuesPath"]);
+	ctx.id = as<int>(ListConst["id"]);
 
-	G_Elevation = as<NumericMatrix>(ListConst["G_ELEV_RANGE.26"]);
-	NeighbouringCells = as<NumericMatrix>(ListConst["NeighbouringCells"]);
+	ctx.Temp = ForcingMatrix(as<NumericMatrix>(ListConst["temp"]));
+	ctx.Rs = ForcingMatrix(as<NumericMatrix>(ListConst["shortwave"]));
+	ctx.Rl = ForcingMatrix(as<NumericMatrix>(ListConst["longwave"]));
+	ctx.Prec = ForcingMatrix(as<NumericMatrix>(ListConst["prec"]));
+	ctx.GR = as<IntegerVector>(ListConst["GR"]);
 
-	LAI_max = as<NumericVector>(ListConst["LAI_max"]);
-	LAI_min = as<NumericVector>(ListConst["LAI_min"]);
-	initDays = as<NumericVector>(ListConst["initDays"]);
-	GLCT = as<NumericVector>(ListConst["GLCT"]);
+	ctx.G_Elevation = as<NumericMatrix>(ListConst["G_ELEV_RANGE.26"]);
+	ctx.NeighbouringCells = as<NumericMatrix>(ListConst["NeighbouringCells"]);
 
-	albedo = as<NumericVector>(ListConst["albedo"]);
-	albedoSnow = as<NumericVector>(ListConst["albedoSnow"]);
-	emissivity = as<NumericVector>(ListConst["emissivity"]);
-	alphaPT = as<NumericVector>(ListConst["alphaPT"]);
-	degreeDayFactor = as<NumericVector>(ListConst["degreeDayFactor"]);
-	GBUILTUP = as<NumericVector>(ListConst["GBUILTUP"]);
-	G_GAMMA_HBV = as<NumericVector>(ListConst["G_GAMMA_HBV"]);
-	maxDailyPET = as<NumericVector>(ListConst["maxDailyPET"]);
-	G_Smax = as<NumericVector>(ListConst["G_Smax"]);
-	G_ARID_HUMID = as<IntegerVector>(ListConst["G_ARID_HUMID"]);
-	G_TEXTURE = as<NumericVector>(ListConst["G_TEXTURE"]);
-	G_gwFactor = as<NumericVector>(ListConst["G_gwFactor"]);
-	G_RG_max = as<NumericVector>(ListConst["G_RG_max"]);
-	GAREA = as<NumericVector>(ListConst["GAREA"]);
-	landfrac = as<NumericVector>(ListConst["landfrac"]);
-	G_ALLOC_COEFF = as<NumericVector>(ListConst["G_ALLOC_COEFF.20"]);
-	G_LOCLAK = as<IntegerVector>(ListConst["G_LOCLAK"]);
-	G_LOCWET = as<IntegerVector>(ListConst["G_LOCWET"]);
-	G_GLOLAK = as<IntegerVector>(ListConst["G_GLOLAK"]);
-	G_GLOWET = as<IntegerVector>(ListConst["G_GLOWET"]);
-	G_RESAREA = as<NumericVector>(ListConst["G_RESAREA"]);
-	G_LAKAREA = as<NumericVector>(ListConst["G_LAKAREA"]);
-	G_STORAGE_CAPACITY = as<NumericVector>(ListConst["G_STORAGE_CAPACITY"]);
-	G_MEAN_INFLOW = as<NumericVector>(ListConst["G_MEAN_INFLOW"]);
-	G_START_MONTH = as<IntegerVector>(ListConst["G_START_MONTH"]);
-	G_RES_TYPE = as<IntegerVector>(ListConst["G_RES_TYPE"]);
-	routeOrder = as<IntegerVector>(ListConst["routeOrder"]);
-	outflowOrder = as<IntegerVector>(ListConst["outflow"]);
+	ctx.LAI_max = as<NumericVector>(ListConst["LAI_max"]);
+	ctx.LAI_min = as<NumericVector>(ListConst["LAI_min"]);
+	ctx.initDays = as<NumericVector>(ListConst["initDays"]);
+	ctx.GLCT = as<NumericVector>(ListConst["GLCT"]);
 
-	G_riverLength = as<NumericVector>(ListConst["G_riverLength"]);
-	G_BANKFULL = as<NumericVector>(ListConst["G_BANKFULL"]);
-	G_riverSlope = as<NumericVector>(ListConst["G_riverSlope"]);
-	G_riverRoughness = as<NumericVector>(ListConst["G_riverRoughness"]);
+	ctx.outflowOrder = as<IntegerVector>(ListConst["outflow"]);
+	// routing levels are derived from the flow network (longest upstream path -> few levels with many cells)
+	// compatibility: routeOrder of the input (rank of flow accumulation) is used, if it is part of ListConst
+	if (ListConst.containsElementNamed("routeOrder")) {
+		ctx.routeOrder = as<IntegerVector>(ListConst["routeOrder"]);
+	} else {
+		ctx.routeOrder = calcRoutingLevels(ctx.outflowOrder);
+	}
+	// optional: number of threads used for routing (cells of one routing step with at least minCellsParallel cells are simulated in parallel)
+	ctx.nThreadsRouting = 1;
+	if (ListConst.containsElementNamed("nThreadsRouting")) {
+		ctx.nThreadsRouting = max(as<int>(ListConst["nThreadsRouting"]), 1);
+	}
+	ctx.minCellsParallel = 64;
+	if (ListConst.containsElementNamed("minCellsParallel")) {
+		ctx.minCellsParallel = max(as<int>(ListConst["minCellsParallel"]), 1);
+	}
 
-	Splitfactor = as<NumericVector>(ListConst["Splitfactor"]);
+	// optional: routing of subtrees of the network for blocks of days without water use (default FALSE = day by day, see simulateRoutingBlocked())
+	ctx.routingBlocked = false;
+	if (ListConst.containsElementNamed("routingBlocked")) {
+		ctx.routingBlocked = as<bool>(ListConst["routingBlocked"]);
+	}
+	ctx.maxSubtreeSize = 256;
+	if (ListConst.containsElementNamed("maxSubtreeSize")) {
+		ctx.maxSubtreeSize = max(as<int>(ListConst["maxSubtreeSize"]), 1);
+	}
 
-	Info_GW = as<NumericMatrix>(ListConst["Info_GW"]);
-	Info_SW = as<NumericMatrix>(ListConst["Info_SW"]);
-	Info_TF = as<NumericMatrix>(ListConst["Info_TF"]);
-	YearlyMeanDemand = as<NumericVector>(ListConst["G_NUs_7100"]);
+	// optional: vectorized daily kernels are used if the CPU supports them (default TRUE, see VectorMath.h)
+	ctx.simdLevel = vectorLevel();
+	if (ListConst.containsElementNamed("useSIMD") && !as<bool>(ListConst["useSIMD"])) {
+		ctx.simdLevel = 0;
+	}
 
-	maxCanopyStoragePerLAI = as<double>(ListConst["maxCanopyStoragePerLAI"]);
-	canopyEvapoExp = as<double>(ListConst["canopyEvapoExp"]);
-	array_size = as<int>(ListConst["array_size"]);
-	snowFreezeTemp = as<double>(ListConst["snowFreezeTemp"]);
-	snowMeltTemp = as<double>(ListConst["snowMeltTemp"]);
-	runoffFracBuiltUp = as<double>(ListConst["runoffFracBuiltUp"]);
-	pcrit = as<double>(ListConst["pcrit"]);
-	k_g = as<double>(ListConst["k_g"]);
-	lakeDepth = as<double>(ListConst["lakeDepth"]);
-	lakeOutflowExp = as<double>(ListConst["lakeOutflowExp"]);
-	wetlandDepth = as<double>(ListConst["wetlandDepth"]);
-	wetlOutflowExp = as<double>(ListConst["wetlOutflowExp"]);
-	evapoReductionExp = as<double>(ListConst["evapoReductionExp"]);
-	evapoReductionExpReservoir = as<double>(ListConst["evapoReductionExpReservoir"]);
-	glo_storageFactor = as<int>(ListConst["glo_storageFactor"]);
-	loc_storageFactor = as<int>(ListConst["loc_storageFactor"]);
-	cor_row = as<int>(ListConst["cor_row"]);
+	ctx.par.init(ListConst); // cell parameters (albedo, G_Smax, GAREA, ...)
+
+	ctx.Info_GW = as<NumericMatrix>(ListConst["Info_GW"]);
+	ctx.Info_SW = as<NumericMatrix>(ListConst["Info_SW"]);
+	ctx.Info_TF = as<NumericMatrix>(ListConst["Info_TF"]);
+	ctx.YearlyMeanDemand = as<NumericVector>(ListConst["G_NUs_7100"]);
+
+	ctx.maxCanopyStoragePerLAI = as<double>(ListConst["maxCanopyStoragePerLAI"]);
+	ctx.canopyEvapoExp = as<double>(ListConst["canopyEvapoExp"]);
+	ctx.array_size = as<int>(ListConst["array_size"]);
+	ctx.snowFreezeTemp = as<double>(ListConst["snowFreezeTemp"]);
+	ctx.snowMeltTemp = as<double>(ListConst["snowMeltTemp"]);
+	ctx.runoffFracBuiltUp = as<double>(ListConst["runoffFracBuiltUp"]);
+	ctx.pcrit = as<double>(ListConst["pcrit"]);
+	ctx.k_g = as<double>(ListConst["k_g"]);
+	ctx.lakeDepth = as<double>(ListConst["lakeDepth"]);
+	ctx.lakeOutflowExp = as<double>(ListConst["lakeOutflowExp"]);
+	ctx.wetlandDepth = as<double>(ListConst["wetlandDepth"]);
+	ctx.wetlOutflowExp = as<double>(ListConst["wetlOutflowExp"]);
+	ctx.evapoReductionExp = as<double>(ListConst["evapoReductionExp"]);
+	ctx.evapoReductionExpReservoir = as<double>(ListConst["evapoReductionExpReservoir"]);
+	ctx.glo_storageFactor = as<int>(ListConst["glo_storageFactor"]);
+	ctx.loc_storageFactor = as<int>(ListConst["loc_storageFactor"]);
+	ctx.cor_row = as<int>(ListConst["cor_row"]);
+	if (ctx.calcLong == 1) {
+		ctx.radTable.init(ctx.GR, ctx.cor_row, false); // for dailyEstimateLongwave()
+	}
 
-	defaultRiverVelocity = as<double>(ListConst["defaultRiverVelocity"]);
+	ctx.defaultRiverVelocity = as<double>(ListConst["defaultRiverVelocity"]);
 
-	dailyLaiAll = getLAIdaily(LAI_min, LAI_max, initDays,
-						   Temp, Prec, G_ARID_HUMID, GLCT);
 
 }
 
@@ -1,4 +1,15 @@
 #include <Rcpp.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <vector>
+#include <string>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 #include "initModel.h"
 #include "initializeModel.h"
 
@@ -6,10 +17,6 @@ using namespace Rcpp;
 using namespace std;
 
 NumericVector readFile(const char* file);
-NumericMatrix readFile(const char* file, int rows);
-
-void writeFile(const char* file, NumericVector vector2write);
-void writeFile(const char* file, NumericMatrix matrix2write);
 
 String combineStrings(String string1, String string2, String String2insert);
 
@@ -17,171 +24,253 @@ String getLastEntry(DateVector vector2examine);
 String getFirstEntry(DateVector vector2examine);
 String fillWithZeros(String string2fill, int n_zero);
 
-NumericVector changeVals(NumericVector v2change, NumericVector v2use); // sets values safely
-NumericMatrix changeVals(NumericMatrix v2change, NumericMatrix v2use);  // sets values safely
-NumericVector changeVals(NumericVector v2change, NumericVector v2use, const char* Filename); // sets values safely
-NumericMatrix changeVals(NumericMatrix v2change, NumericMatrix v2use, const char* Filename);  // sets values safely
+// system values (storages at the beginning of a day) of a basin are kept in one file <id>_<date>_Storages.bin:
+// header | variable table | values (double, byte order of the machine that wrote the file)
+// the checksum is FNV-1a over the 64-bit words after the header
+static const char storageFileMagic[8] = {'W', 'G', 'H', 'M', 'S', 'T', 'O', 'R'};
+static const uint32_t storageFileVersion = 1;
 
-void setStorages(DateVector SimPeriod){
-	//beginning of the day
-	NumericVector dummy;
-	NumericMatrix dummy2;
-	String id_string = std::to_string(id);
-	String date4Values = getFirstEntry(SimPeriod);
+struct StorageFileHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t nVars;
+	int32_t id;
+	int32_t date; // yyyymmdd
+	int32_t arraySize;
+	int32_t nSubgrids; // rows of G_snowWaterEquivalent
+	uint64_t dataSize; // bytes after the header
+	uint64_t checksum;
+};
+
+struct StorageFileEntry {
+	char name[32];
+	uint64_t offset; // bytes from the beginning of the file
+	uint64_t length; // number of values
+};
+
+struct StorageVar {
+	const char* name;
+	double* values;
+	size_t length;
+};
+
+// storages that are written to / read from the system values
+static vector<StorageVar> storageVars(ModelContext& ctx){
+	vector<StorageVar> vars;
+	vars.push_back({"G_canopyWaterContent", ctx.G_canopyWaterContent.begin(), (size_t) ctx.G_canopyWaterContent.length()});
+	vars.push_back({"G_snow", ctx.G_snow.begin(), (size_t) ctx.G_snow.length()});
+	vars.push_back({"G_snowWaterEquivalent", ctx.G_snowWaterEquivalent.begin(), (size_t) ctx.G_snowWaterEquivalent.length()});
+	vars.push_back({"G_soilWaterContent", ctx.G_soilWaterContent.begin(), (size_t) ctx.G_soilWaterContent.length()});
+	vars.push_back({"G_groundwater", ctx.G_groundwater.begin(), (size_t) ctx.G_groundwater.length()});
+	vars.push_back({"S_river", ctx.S_river.begin(), (size_t) ctx.S_river.length()});
+	vars.push_back({"S_locLakeStorage", ctx.S_locLakeStorage.begin(), (size_t) ctx.S_locLakeStorage.length()});
+	vars.push_back({"S_locWetlandStorage", ctx.S_locWetlandStorage.begin(), (size_t) ctx.S_locWetlandStorage.length()});
+	vars.push_back({"S_gloLakeStorage", ctx.S_gloLakeStorage.begin(), (size_t) ctx.S_gloLakeStorage.length()});
+	vars.push_back({"S_ResStorage", ctx.S_ResStorage.begin(), (size_t) ctx.S_ResStorage.length()});
+	vars.push_back({"S_gloWetlandStorage", ctx.S_gloWetlandStorage.begin(), (size_t) ctx.S_gloWetlandStorage.length()});
+	return(vars);
+}
+
+static uint64_t storageChecksum(const char* data, size_t n){
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i = 0; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t)){
+		uint64_t word;
+		memcpy(&word, data + i, sizeof(word));
+		hash = (hash ^ word) * 1099511628211ULL;
+	}
+	return(hash);
+}
+
+static string storageFile(ModelContext& ctx, String date4Values){
+	String id_string = std::to_string(ctx.id);
 	String prefix = combineStrings(id_string, date4Values, "_");
-	
-	//canopy
-	String nameCanopy = combineStrings(prefix, "G_canopyWaterContent.bin", "_");
-	String pathCanopy = combineStrings(SystemValues, nameCanopy, "/");
-	const char* pathCanopy_char = pathCanopy.get_cstring();
-	dummy = readFile(pathCanopy_char);
-	G_canopyWaterContent=changeVals(G_canopyWaterContent, dummy, pathCanopy_char);
+	String name = combineStrings(prefix, "Storages.bin", "_");
+	String path = combineStrings(ctx.SystemValues, name, "/");
+	return(string(path.get_cstring()));
+}
 
-	
-	//reading snow
-	String nameSnow = combineStrings(prefix, "G_snow.bin", "_");
-	String pathSnow = combineStrings(SystemValues, nameSnow, "/");
-	const char* pathSnow_char = pathSnow.get_cstring();
-	dummy = readFile(pathSnow_char);
-	G_snow=changeVals(G_snow, dummy, pathSnow_char);
-	
-	//reading snowMatrix 
-	String nameSnowWE = combineStrings(prefix, "G_snowWaterEquivalent.bin", "_");
-	String pathSnowWE = combineStrings(SystemValues, nameSnowWE, "/");
-	const char* pathSnowWE_char = pathSnowWE.get_cstring();
-	dummy2 = readFile(pathSnowWE_char, 25);
-	G_snowWaterEquivalent=changeVals(G_snowWaterEquivalent, dummy2, pathSnowWE_char);
-	
-	//reading soil
-	String nameSoil = combineStrings(prefix, "G_soilWaterContent.bin", "_");
-	String pathSoil = combineStrings(SystemValues, nameSoil, "/");
-	const char* pathSoil_char = pathSoil.get_cstring();
-	dummy = readFile(pathSoil_char);
-	G_soilWaterContent=changeVals(G_soilWaterContent, dummy, pathSoil_char);
-	
-	//writing groundwater
-	String nameGW = combineStrings(prefix, "G_groundwater.bin", "_");
-	String pathGW = combineStrings(SystemValues, nameGW, "/");
-	const char* pathGW_char = pathGW.get_cstring();
-	dummy = readFile(pathGW_char);
-	G_groundwater=changeVals(G_groundwater, dummy, pathGW_char);
+static bool fileExists(const char* file){
+	FILE *file_ptr = fopen(file, "rb");
+	if (file_ptr == NULL) return(false);
+	fclose(file_ptr);
+	return(true);
+}
 
-	//writing river
-	String nameRiver = combineStrings(prefix, "S_river.bin", "_");
-	String pathRiver = combineStrings(SystemValues, nameRiver, "/");
-	const char* pathRiver_char = pathRiver.get_cstring();
-	dummy = readFile(pathRiver_char);
-	S_river=changeVals(S_river, dummy, pathRiver_char);
-	
-	//writing S_locLakeStorage
-	String nameLocLak = combineStrings(prefix, "S_locLakeStorage.bin", "_");
-	String pathLocLak = combineStrings(SystemValues, nameLocLak, "/");
-	const char* pathLocLak_char = pathLocLak.get_cstring();
-	dummy = readFile(pathLocLak_char);
-	S_locLakeStorage=changeVals(S_locLakeStorage, dummy, pathLocLak_char);
-	
-	//writing S_locWetlandStorage
-	String nameLocWet = combineStrings(prefix, "S_locWetlandStorage.bin", "_");
-	String pathLocWet = combineStrings(SystemValues, nameLocWet, "/");
-	const char* pathLocWet_char = pathLocWet.get_cstring();
-	dummy = readFile(pathLocWet_char);
-	S_locWetlandStorage=changeVals(S_locWetlandStorage, dummy, pathLocWet_char);
-	
-	//writing S_gloLakeStorage
-	String nameGloLak = combineStrings(prefix, "S_gloLakeStorage.bin", "_");
-	String pathGloLak = combineStrings(SystemValues, nameGloLak, "/");
-	const char* pathGloLak_char = pathGloLak.get_cstring();
-	dummy = readFile(pathGloLak_char);
-	S_gloLakeStorage=changeVals(S_gloLakeStorage, dummy, pathGloLak_char);
+// whole file in memory: mmap (read only) or, without POSIX, read into a buffer
+class StorageFileReader {
+public:
+	StorageFileReader(const char* file) : data(NULL), size(0), mapped(false) {
+#ifndef _WIN32
+		int fd = open(file, O_RDONLY);
+		if (fd < 0) { Rcpp::stop("File Error: %s not found", file);}
+		struct stat st;
+		if (fstat(fd, &st) != 0) { close(fd); Rcpp::stop("File Error: %s cannot be read", file);}
+		size = (size_t) st.st_size;
+		if (size > 0) {
+			void* p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			close(fd);
+			if (p == MAP_FAILED) { Rcpp::stop("File Error: %s cannot be mapped", file);}
+			data = (const char*) p;
+			mapped = true;
+		} else {
+			close(fd);
+		}
+#else
+		FILE *file_ptr = fopen(file, "rb");
+		if (file_ptr == NULL) { Rcpp::stop("File Error: %s not found", file);}
+		fseek(file_ptr, 0, SEEK_END);
+		size = (size_t) ftell(file_ptr);
+		rewind(file_ptr);
+		buffer.resize(size);
+		size_t result = (size > 0) ? fread(&buffer[0], 1, size, file_ptr) : 0;
+		fclose(file_ptr);
+		if (result != size) { Rcpp::stop("File Error: %s cannot be read", file);}
+		data = buffer.data();
+#endif
+	}
+
+	~StorageFileReader(){
+#ifndef _WIN32
+		if (mapped) munmap((void*) data, size);
+#endif
+	}
+
+	const char* data;
+	size_t size;
+
+private:
+	bool mapped;
+	vector<char> buffer;
+};
+
+// old format: one file per storage (<id>_<date>_<storage>.bin, without header)
+static void setStoragesLegacy(ModelContext& ctx, String prefix){
+	vector<StorageVar> vars = storageVars(ctx);
+	for (size_t v = 0; v < vars.size(); v++){
+		String nameVar = combineStrings(prefix, combineStrings(vars[v].name, "bin", "."), "_");
+		String pathVar = combineStrings(ctx.SystemValues, nameVar, "/");
+		const char* pathVar_char = pathVar.get_cstring();
+		NumericVector dummy = readFile(pathVar_char);
+		if ((size_t) dummy.length() != vars[v].length){
+			Rcpp::stop("Vectors are not compatible for file %s! object to change has size %u and object to use for change as size %u", pathVar_char, (unsigned) vars[v].length, (unsigned) dummy.length());
+		}
+		copy(dummy.begin(), dummy.end(), vars[v].values);
+	}
+}
+
+void setStorages(ModelContext& ctx, DateVector SimPeriod){
+	//beginning of the day
+	String date4Values = getFirstEntry(SimPeriod);
+	string path = storageFile(ctx, date4Values);
+	const char* file = path.c_str();
+	
+	if (!fileExists(file)) {
+		String prefix = combineStrings(std::to_string(ctx.id), date4Values, "_");
+		String pathCanopy = combineStrings(ctx.SystemValues, combineStrings(prefix, "G_canopyWaterContent.bin", "_"), "/");
+		if (fileExists(pathCanopy.get_cstring())) {
+			setStoragesLegacy(ctx, prefix);
+			return;
+		}
+		Rcpp::stop("File Error: %s not found", file);
+	}
 	
-	//writing S_ResStorage
-	String nameRes = combineStrings(prefix, "S_ResStorage.bin", "_");
-	String pathRes = combineStrings(SystemValues, nameRes, "/");
-	const char* pathRes_char = pathRes.get_cstring();
-	dummy = readFile(pathRes_char);
-	S_ResStorage=changeVals(S_ResStorage, dummy, pathRes_char);
+	StorageFileReader reader(file);
 	
-	//writing S_gloWetlandStorage
-	String nameGloWet = combineStrings(prefix, "S_gloWetlandStorage.bin", "_");
-	String pathGloWet = combineStrings(SystemValues, nameGloWet, "/");
-	const char* pathGloWet_char = pathGloWet.get_cstring();
-	dummy = readFile(pathGloWet_char);
-	S_gloWetlandStorage=changeVals(S_gloWetlandStorage, dummy, pathGloWet_char);
+	StorageFileHeader header;
+	if (reader.size < sizeof(header)) { Rcpp::stop("File Error: %s is not a storage file", file);}
+	memcpy(&header, reader.data, sizeof(header));
+	if (memcmp(header.magic, storageFileMagic, sizeof(storageFileMagic)) != 0) { Rcpp::stop("File Error: %s is not a storage file", file);}
+	if (header.version != storageFileVersion) { Rcpp::stop("File Error: %s has version %u, expected %u", file, (unsigned) header.version, (unsigned) storageFileVersion);}
+	if (header.dataSize != reader.size - sizeof(header)) { Rcpp::stop("File Error: %s is truncated", file);}
+	if (header.checksum != storageChecksum(reader.data + sizeof(header), header.dataSize)) { Rcpp::stop("File Error: checksum of %s does not match", file);}
 	
+	if ((header.id != ctx.id) || (header.date != atoi(date4Values.get_cstring()))) {
+		Rcpp::stop("File Error: %s contains storages of basin %d at %d", file, (int) header.id, (int) header.date);
+	}
+	if ((header.arraySize != ctx.array_size) || (header.nSubgrids != ctx.G_snowWaterEquivalent.nrow())) {
+		Rcpp::stop("File Error: %s has %d cells with %d subgrids, model has %d cells with %d subgrids", file, (int) header.arraySize,
+					(int) header.nSubgrids, ctx.array_size, (int) ctx.G_snowWaterEquivalent.nrow());
+	}
+	if ((uint64_t) header.nVars * sizeof(StorageFileEntry) > header.dataSize) { Rcpp::stop("File Error: %s is truncated", file);}
+	
+	// values are copied from the mapped file directly into the storages
+	vector<StorageVar> vars = storageVars(ctx);
+	for (size_t v = 0; v < vars.size(); v++){
+		bool found = false;
+		for (uint32_t e = 0; e < header.nVars; e++){
+			StorageFileEntry entry;
+			memcpy(&entry, reader.data + sizeof(header) + e * sizeof(entry), sizeof(entry));
+			if (strncmp(entry.name, vars[v].name, sizeof(entry.name)) != 0) continue;
+			
+			if (entry.length != vars[v].length) {
+				Rcpp::stop("Vectors are not compatible for %s in file %s! object to change has size %u and object to use for change as size %u",
+							vars[v].name, file, (unsigned) vars[v].length, (unsigned) entry.length);
+			}
+			if ((entry.offset > reader.size) || (entry.length * sizeof(double) > reader.size - entry.offset)) {
+				Rcpp::stop("File Error: %s is truncated", file);
+			}
+			memcpy(vars[v].values, reader.data + entry.offset, entry.length * sizeof(double));
+			found = true;
+			break;
+		}
+		if (!found) { Rcpp::stop("File Error: %s does not contain %s", file, vars[v].name);}
+	}
 }
 
-void writeStorages(DateVector SimPeriod){
+void writeStorages(ModelContext& ctx, DateVector SimPeriod){
 	// end of the day -> for beginning of next day
-	String id_string = std::to_string(id);
 	String date4Values = getLastEntry(SimPeriod);
-	String prefix = combineStrings(id_string, date4Values, "_");
-	
-	//writing canopy
-	String nameCanopy = combineStrings(prefix, "G_canopyWaterContent.bin", "_");
-	String pathCanopy = combineStrings(SystemValues, nameCanopy, "/");
-	const char* pathCanopy_char = pathCanopy.get_cstring();
-	writeFile(pathCanopy_char, G_canopyWaterContent);
-	
-	//writing snow
-	String nameSnow = combineStrings(prefix, "G_snow.bin", "_");
-	String pathSnow = combineStrings(SystemValues, nameSnow, "/");
-	const char* pathSnow_char = pathSnow.get_cstring();
-	writeFile(pathSnow_char, G_snow);
-	
-	//writing snowMatrix 
-	String nameSnowWE = combineStrings(prefix, "G_snowWaterEquivalent.bin", "_");
-	String pathSnowWE = combineStrings(SystemValues, nameSnowWE, "/");
-	const char* pathSnowWE_char = pathSnowWE.get_cstring();
-	writeFile(pathSnowWE_char, G_snowWaterEquivalent);
-	
-	
-	//writing soil
-	String nameSoil = combineStrings(prefix, "G_soilWaterContent.bin", "_");
-	String pathSoil = combineStrings(SystemValues, nameSoil, "/");
-	const char* pathSoil_char = pathSoil.get_cstring();
-	writeFile(pathSoil_char, G_soilWaterContent);
-	
-	//writing groundwater
-	String nameGW = combineStrings(prefix, "G_groundwater.bin", "_");
-	String pathGW = combineStrings(SystemValues, nameGW, "/");
-	const char* pathGW_char = pathGW.get_cstring();
-	writeFile(pathGW_char, G_groundwater);
-	
-	//writing river
-	String nameRiver = combineStrings(prefix, "S_river.bin", "_");
-	String pathRiver = combineStrings(SystemValues, nameRiver, "/");
-	const char* pathRiver_char = pathRiver.get_cstring();
-	writeFile(pathRiver_char, S_river);
-	
-	//writing S_locLakeStorage
-	String nameLocLak = combineStrings(prefix, "S_locLakeStorage.bin", "_");
-	String pathLocLak = combineStrings(SystemValues, nameLocLak, "/");
-	const char* pathLocLak_char = pathLocLak.get_cstring();
-	writeFile(pathLocLak_char, S_locLakeStorage);
-	
-	//writing S_locWetlandStorage
-	String nameLocWet = combineStrings(prefix, "S_locWetlandStorage.bin", "_");
-	String pathLocWet = combineStrings(SystemValues, nameLocWet, "/");
-	const char* pathLocWet_char = pathLocWet.get_cstring();
-	writeFile(pathLocWet_char, S_locWetlandStorage);
-	
-	//writing S_gloLakeStorage
-	String nameGloLak = combineStrings(prefix, "S_gloLakeStorage.bin", "_");
-	String pathGloLak = combineStrings(SystemValues, nameGloLak, "/");
-	const char* pathGloLak_char = pathGloLak.get_cstring();
-	writeFile(pathGloLak_char, S_gloLakeStorage);
-	
-	//writing S_ResStorage
-	String nameRes = combineStrings(prefix, "S_ResStorage.bin", "_");
-	String pathRes = combineStrings(SystemValues, nameRes, "/");
-	const char* pathRes_char = pathRes.get_cstring();
-	writeFile(pathRes_char, S_ResStorage);
+	string path = storageFile(ctx, date4Values);
+	vector<StorageVar> vars = storageVars(ctx);
+	
+	// whole file is built in one buffer
+	size_t offset = sizeof(StorageFileHeader) + vars.size() * sizeof(StorageFileEntry);
+	size_t fileSize = offset;
+	for (size_t v = 0; v < vars.size(); v++){
+		fileSize += vars[v].length * sizeof(double);
+	}
+	vector<char> buffer(fileSize, 0);
+	
+	for (size_t v = 0; v < vars.size(); v++){
+		StorageFileEntry entry;
+		memset(&entry, 0, sizeof(entry));
+		strncpy(entry.name, vars[v].name, sizeof(entry.name) - 1);
+		entry.offset = offset;
+		entry.length = vars[v].length;
+		memcpy(&buffer[sizeof(StorageFileHeader) + v * sizeof(entry)], &entry, sizeof(entry));
+		if (vars[v].length > 0) memcpy(&buffer[offset], vars[v].values, vars[v].length * sizeof(double));
+		offset += vars[v].length * sizeof(double);
+	}
 	
-	//writing S_gloWetlandStorage
-	String nameGloWet = combineStrings(prefix, "S_gloWetlandStorage.bin", "_");
-	String pathGloWet = combineStrings(SystemValues, nameGloWet, "/");
-	const char* pathGloWet_char = pathGloWet.get_cstring();
-	writeFile(pathGloWet_char, S_gloWetlandStorage);
+	StorageFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, storageFileMagic, sizeof(storageFileMagic));
+	header.version = storageFileVersion;
+	header.nVars = (uint32_t) vars.size();
+	header.id = ctx.id;
+	header.date = atoi(date4Values.get_cstring());
+	header.arraySize = ctx.array_size;
+	header.nSubgrids = ctx.G_snowWaterEquivalent.nrow();
+	header.dataSize = fileSize - sizeof(header);
+	header.checksum = storageChecksum(&buffer[sizeof(header)], header.dataSize);
+	memcpy(&buffer[0], &header, sizeof(header));
+	
+	// written to a temporary file first, so that a run that stops while writing does not leave a broken file
+	string pathTmp = path + ".tmp";
+	FILE *file_ptr = fopen(pathTmp.c_str(), "wb");
+	if (file_ptr == NULL) { Rcpp::stop("File Error: %s cannot be opened", pathTmp.c_str());}
+	size_t result = fwrite(&buffer[0], 1, fileSize, file_ptr);
+	if ((fclose(file_ptr) != 0) || (result != fileSize)) {
+		remove(pathTmp.c_str());
+		Rcpp::stop("File Error: %s cannot be written", pathTmp.c_str());
+	}
+#ifdef _WIN32
+	remove(path.c_str()); // rename does not replace existing files
+#endif
+	if (rename(pathTmp.c_str(), path.c_str()) != 0) {
+		remove(pathTmp.c_str());
+		Rcpp::stop("File Error: %s cannot be written", path.c_str());
+	}
 }
 
 String getLastEntry(DateVector vector2examine){
@@ -248,45 +337,6 @@ String getFirstEntry(DateVector vector2examine){
 }
 
 
-void writeFile(const char* file, NumericVector vector2write){
-  
-  const static int n = vector2write.size();
-  FILE *file_ptr;
-  file_ptr = fopen(file, "wb");
-  if (file_ptr == NULL) { Rcpp::stop("File Error: %s not found", file);}
-  
-  std::vector<double> vector2write_std(n);
-  vector2write_std = as<std::vector<double> >(vector2write);
-  
-  if (vector2write_std.size() == 0){
-	  Rcpp::warning("Warning: information to write to file %s is empty", file);}
-	  
-  fwrite(&vector2write_std[0], sizeof(double), vector2write_std.size(), file_ptr);
-  fclose(file_ptr);
-}
-
-//for matrix
-void writeFile(const char* file, NumericMatrix matrix2write){
-  
-  NumericVector vector2write = NumericVector(matrix2write);
-  const static int n = vector2write.size();
-  
-  std::vector<double> vector2write_std(n);
-  vector2write_std = as<std::vector<double> >(vector2write);
-  
-  FILE *file_ptr;
-  file_ptr = fopen(file, "wb");
-  if (file_ptr == NULL) { Rcpp::stop("File Error: %s not found", file);}
-  
-    if (vector2write_std.size() == 0){
-	   Rcpp::warning("Warning: information to write to file %s is empty", file);}
-	  
-  fwrite(&vector2write_std[0], sizeof(double), vector2write_std.size(), file_ptr);
-  fclose(file_ptr); 
-}
-
-
-
 NumericVector readFile(const char* file){
   
   NumericVector vector2read_rcpp;
@@ -320,44 +370,6 @@ NumericVector readFile(const char* file){
   
 }
 
-//for matrix
-NumericMatrix readFile(const char* file, int rows){
-  
-  NumericMatrix matrix2read;
-  NumericVector vector2read_rcpp;
-  
-  FILE *file_ptr;
-  unsigned long lSize;
-  
-  //opening file
-  file_ptr = fopen(file, "rb");
-  if (file_ptr == NULL) { Rcpp::stop("File Error: %s not found", file) ;}
-  
-  //obtaining number of elements to be read
-  fseek (file_ptr , 0 , SEEK_END); //goes to the end
-  lSize = ftell (file_ptr); // tells number
-  rewind (file_ptr); // goes to the front
-  //static const size_t elem1 = lSize/sizeof(double);
-  size_t elem2 = lSize/sizeof(double);
-  
-  //defining vector to store read input
-  std::vector<double> vector2read(elem2);
-  
-    //reading & closing
-  size_t result = fread(&vector2read[0], sizeof(double), elem2, file_ptr);
-  fclose(file_ptr);
-  if (result > 0) {
-	  vector2read_rcpp = wrap(vector2read); // wrap x into an R object
-	  vector2read_rcpp.attr("dim") = Dimension(rows, elem2/rows);
-	  matrix2read = as<NumericMatrix>(vector2read_rcpp);
-  } else {
-	  Rcpp::stop("File Error: %s File is empty", file);
-  }
-  
-  return(matrix2read);
-  
-}
-
 
 String combineStrings(String string1, String string2, String String2insert){
     String string3;
@@ -367,62 +379,3 @@ String combineStrings(String string1, String string2, String String2insert){
 
 	return(string3);
 }
-
-NumericMatrix changeVals(NumericMatrix v2change, NumericMatrix v2use) {
-	int nRow1 = v2change.nrow(); 
-	int nCol1 = v2change.ncol(); 
-	
-	int nRow2 = v2use.nrow(); 
-	int nCol2 = v2use.ncol(); 
-	
-	if ((nRow2 != nRow1) | (nCol2 != nCol1)) {
-	  Rcpp::stop("Matrices are not compatible! object to change has size (%u,%u) and object to use for change as size (%u,%u)", nRow1, nCol1, nRow2, nCol2);
-	} else {
-	  v2change = v2use; //changes also length!
-	}
-	return(v2change);
-}
-
-
-NumericVector changeVals(NumericVector v2change, NumericVector v2use) {
-	int n1 = v2change.length(); 
-	int n2 = v2use.length();
-	if (n1 != n2){
-	  Rcpp::stop("Vectors are not compatible! object to change has size %u and object to use for change as size %u", n1, n2);
-	} else {
-	  v2change = v2use; //changes also length!
-	}
-	return(v2change);
-}
-
-NumericMatrix changeVals(NumericMatrix v2change, NumericMatrix v2use, const char* Filename) {
-	
-	//const char* Filename_c = Filename.get_cstring();
-	int nRow1 = v2change.nrow(); 
-	int nCol1 = v2change.ncol(); 
-	
-	int nRow2 = v2use.nrow(); 
-	int nCol2 = v2use.ncol(); 
-	
-	if ((nRow2 != nRow1) | (nCol2 != nCol1)) {
-	  Rcpp::stop("Matrices are not compatible for file %s! object to change has size (%u,%u) and object to use for change as size (%u,%u)", Filename, nRow1, nCol1, nRow2, nCol2);
-	} else {
-	  v2change = v2use; //changes also length!
-	}
-	return(v2change);
-}
-
-
-NumericVector changeVals(NumericVector v2change, NumericVector v2use, const char* Filename) {
-	
-	//const char* Filename_c = Filename.get_cstring();
-	
-	int n1 = v2change.length(); 
-	int n2 = v2use.length();
-	if (n1 != n2){
-	  Rcpp::stop("Vectors are not compatible for file %s! object to change has size %u and object to use for change as size %u", Filename, n1, n2);
-	} else {
-	  v2change = v2use; //changes also length!
-	}
-	return(v2change);
-}
\ No newline at end of file
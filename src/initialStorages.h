@@ -4,12 +4,13 @@
 #define INITIALSTORAGES_H
  
 #include <Rcpp.h>
+#include "ModelContext.h"
 
 using namespace std;
 using namespace Rcpp;
 
-void setStorages(DateVector SimPeriod);
-void writeStorages(DateVector SimPeriod); 
+void setStorages(ModelContext& ctx, DateVector SimPeriod);
+void writeStorages(ModelContext& ctx, DateVector SimPeriod); 
 
 
 #endif
\ No newline at end of file
@@ -1,164 +1,407 @@
 #include <Rcpp.h>
+#include <algorithm>
+#include <math.h>
 #include "initModel.h"
 #include "initializeModel.h"
+#include "ModelTools.h"
+#include "WaterUsePrepareRoutine.h"
 
 using namespace Rcpp;
 using namespace std;
 
 
-NumericVector G_PETnetShort;
-NumericVector G_PETnetLong;
-
-NumericVector daily_prec_to_soil; 
-NumericVector dailySoilPET; //left energy for evaporation from soil (PET)
-NumericVector dailyCanopyEvapo;
-NumericVector dailySnowMelt; //Snowmelt (flux) per day
-NumericVector dailySnowEvapo; //Sublimation from snow (flux) per day (no changes between sublimation and evaporation)
-NumericVector thresh_elev; //help vector to avoid unlimited snow accumulation in high regions
-NumericVector dailyEffPrec; //Water amount that goes to soil (snowmelt + precipitation (T > 0°C)
-NumericVector immediate_runoff; //Water amount that is transformed directly to surface run-off
-NumericVector dailyAET; // actual evaporation form soil
-NumericVector daily_runoff; //amount of sealed ares in grid [-]
-NumericVector soil_water_overflow; //amount of sealed ares in grid [-]
-NumericVector daily_gw_recharge; 
-NumericVector G_dailyLocalSurfaceRunoff;
-NumericVector G_dailyLocalGWRunoff;
-NumericVector G_dailyUseGW;
-
-//initiliazing storages 
-NumericVector G_canopyWaterContent; //canopy storage is defined (0 content)
-NumericVector G_snow; //Snow storage for every cell and per day
-NumericMatrix G_snowWaterEquivalent; //Snow storage for every subgrid cell and per day
-NumericVector G_soilWaterContent; //soil storage
-NumericVector G_groundwater; // groundwater storage
-
-//Creating help vectors to define routing order
-IntegerVector cellIDs; //cellIDs for actual routing step
-IntegerVector numbers; //routing steps 
-IntegerVector numbersSorted; 
-	
-// ROUTING
+//' @title initSnowBands
+//' @description temperature offsets of the elevation bands of every cell (0.6°C/100m, see dailySnow()),
+//' so that they are not calculated again for every band and day
+void initSnowBands(ModelContext& ctx){
+
+	ctx.nSnowBands = ctx.G_Elevation.nrow() - 1; //1st entry is mean elevation, rest is for subgrids
+	ctx.snowTempOffset.resize((size_t) ctx.nSnowBands * ctx.array_size);
+	ctx.snowMaxTempOffset.resize(ctx.array_size);
+	for (int cell = 0; cell < ctx.array_size; cell++){
+		double maxOffset = -HUGE_VAL;
+		for (int elev = 1; elev <= ctx.nSnowBands; elev++){
+			const double offset = (ctx.G_Elevation(elev, cell) - ctx.G_Elevation(0, cell)) * 0.006;
+			ctx.snowTempOffset[(size_t) cell * ctx.nSnowBands + elev - 1] = offset;
+			maxOffset = max(maxOffset, offset);
+		}
+		ctx.snowMaxTempOffset[cell] = maxOffset;
+	}
+	ctx.snowBandFlux.assign(3 * ctx.nSnowBands, 0.);
+	ctx.snowCovered.assign(ctx.array_size, 1); // not known before the first day
+	ctx.snowActiveCells.reserve(ctx.array_size);
+}
+
+//' @title initRoutingSchedule
+//' @description routing schedule in CSR format: cells are grouped by routing step (routeOrder ascending),
+//' so that routing does not need to search the cells of every routing step on each day;
+//' additionally the upstream cells of every cell are listed, so inflow can be pulled (see getUpstreamInflow())
+void initRoutingSchedule(ModelContext& ctx){
+
+	ctx.routeCells.resize(ctx.array_size);
+	for (int cell = 0; cell < ctx.array_size; cell++){
+		ctx.routeCells[cell] = cell;
+	}
+	const IntegerVector& routeOrder = ctx.routeOrder;
+	stable_sort(ctx.routeCells.begin(), ctx.routeCells.end(), [&routeOrder](int a, int b) { return(routeOrder[a] < routeOrder[b]); });
+
+	ctx.routeStepStart.clear();
+	for (int k = 0; k < ctx.array_size; k++){
+		if ((k == 0) || (routeOrder[ctx.routeCells[k]] != routeOrder[ctx.routeCells[k-1]])){
+			ctx.routeStepStart.push_back(k); // first cell of a new routing step
+		}
+	}
+	ctx.nRouteSteps = ctx.routeStepStart.size();
+	ctx.routeStepStart.push_back(ctx.array_size);
+
+	// upstream cells of every cell (CSR): inflow is pulled from the upstream cells in the order of the routing schedule,
+	// this is the same summation order as adding the outflow to the downstream cell -> identical results
+	ctx.routePosition.resize(ctx.array_size);
+	for (int k = 0; k < ctx.array_size; k++){
+		ctx.routePosition[ctx.routeCells[k]] = k;
+	}
+	const vector<int>& position = ctx.routePosition;
+	ctx.upstreamStart.assign(ctx.array_size + 1, 0);
+	ctx.routeStepsIndependent = true;
+	for (int cell = 0; cell < ctx.array_size; cell++){
+		const int downstreamCell = ctx.outflowOrder[cell] - 1;
+		if ((downstreamCell < 0) || (downstreamCell >= ctx.array_size)) {
+			continue; // outlet
+		}
+		if (routeOrder[cell] >= routeOrder[downstreamCell]) {
+			ctx.routeStepsIndependent = false; // only possible with routeOrder of the input
+		}
+		if (position[cell] < position[downstreamCell]) { // otherwise outflow was never routed to the downstream cell in the same day
+			ctx.upstreamStart[downstreamCell + 1]++;
+		}
+	}
+	for (int cell = 0; cell < ctx.array_size; cell++){
+		ctx.upstreamStart[cell + 1] += ctx.upstreamStart[cell];
+	}
+	ctx.upstreamCells.resize(ctx.upstreamStart[ctx.array_size]);
+	vector<int> next(ctx.upstreamStart.begin(), ctx.upstreamStart.end() - 1);
+	for (int k = 0; k < ctx.array_size; k++){
+		const int cell = ctx.routeCells[k];
+		const int downstreamCell = ctx.outflowOrder[cell] - 1;
+		if ((downstreamCell >= 0) && (downstreamCell < ctx.array_size) && (k < position[downstreamCell])) {
+			ctx.upstreamCells[next[downstreamCell]++] = cell;
+		}
+	}
+}
+
+//' @title initRoutingSubtrees
+//' @description splits the routing network in subtrees of about ctx.maxSubtreeSize cells (greedy from headwaters to outlet):
+//' a subtree only gets inflow from outlets of other subtrees, so it can be simulated for several days at once (see simulateRoutingBlocked());
+//' needs routing schedule (initRoutingSchedule())
+void initRoutingSubtrees(ModelContext& ctx){
+
+	// downstream cell as used in routing (upstream lists of initRoutingSchedule()), -1 = no downstream cell
+	vector<int> downstream(ctx.array_size, -1);
+	for (int cell = 0; cell < ctx.array_size; cell++){
+		for (int i = ctx.upstreamStart[cell]; i < ctx.upstreamStart[cell + 1]; i++){
+			downstream[ctx.upstreamCells[i]] = cell;
+		}
+	}
+
+	// outlet of a subtree: cell where subtree reaches maxSubtreeSize or cell without downstream cell
+	vector<int> size(ctx.array_size, 1); // cells upstream of cell (including cell) that are not part of another subtree yet
+	vector<bool> isOutlet(ctx.array_size);
+	for (int k = 0; k < ctx.array_size; k++){
+		const int cell = ctx.routeCells[k];
+		for (int i = ctx.upstreamStart[cell]; i < ctx.upstreamStart[cell + 1]; i++){
+			if (!isOutlet[ctx.upstreamCells[i]]) {
+				size[cell] += size[ctx.upstreamCells[i]];
+			}
+		}
+		isOutlet[cell] = (downstream[cell] < 0) || (size[cell] >= ctx.maxSubtreeSize);
+	}
+
+	// subtree is defined by its outlet (downstream cells first)
+	ctx.subtreeOf.assign(ctx.array_size, -1);
+	ctx.nSubtrees = 0;
+	for (int k = ctx.array_size - 1; k >= 0; k--){
+		const int cell = ctx.routeCells[k];
+		ctx.subtreeOf[cell] = isOutlet[cell] ? ctx.nSubtrees++ : ctx.subtreeOf[downstream[cell]];
+	}
+
+	// cells of subtrees (CSR) in order of routing schedule
+	ctx.subtreeStart.assign(ctx.nSubtrees + 1, 0);
+	for (int cell = 0; cell < ctx.array_size; cell++){
+		ctx.subtreeStart[ctx.subtreeOf[cell] + 1]++;
+	}
+	for (int s = 0; s < ctx.nSubtrees; s++){
+		ctx.subtreeStart[s + 1] += ctx.subtreeStart[s];
+	}
+	ctx.subtreeCells.resize(ctx.array_size);
+	vector<int> next(ctx.subtreeStart.begin(), ctx.subtreeStart.end() - 1);
+	for (int k = 0; k < ctx.array_size; k++){
+		const int cell = ctx.routeCells[k];
+		ctx.subtreeCells[next[ctx.subtreeOf[cell]]++] = cell;
+	}
+
+	// level of subtrees: 1 + maximal level of upstream subtrees
+	vector<int> level(ctx.nSubtrees, 0);
+	for (int k = 0; k < ctx.array_size; k++){
+		const int cell = ctx.routeCells[k];
+		for (int i = ctx.upstreamStart[cell]; i < ctx.upstreamStart[cell + 1]; i++){
+			const int upstreamSubtree = ctx.subtreeOf[ctx.upstreamCells[i]];
+			if (upstreamSubtree != ctx.subtreeOf[cell]) {
+				level[ctx.subtreeOf[cell]] = max(level[ctx.subtreeOf[cell]], level[upstreamSubtree] + 1);
+			}
+		}
+	}
+	ctx.nSubtreeLevels = 0;
+	for (int s = 0; s < ctx.nSubtrees; s++){
+		ctx.nSubtreeLevels = max(ctx.nSubtreeLevels, level[s] + 1);
+	}
+	ctx.subtreeLevelStart.assign(ctx.nSubtreeLevels + 1, 0);
+	for (int s = 0; s < ctx.nSubtrees; s++){
+		ctx.subtreeLevelStart[level[s] + 1]++;
+	}
+	for (int l = 0; l < ctx.nSubtreeLevels; l++){
+		ctx.subtreeLevelStart[l + 1] += ctx.subtreeLevelStart[l];
+	}
+	ctx.subtreeOrder.resize(ctx.nSubtrees);
+	next.assign(ctx.subtreeLevelStart.begin(), ctx.subtreeLevelStart.end() - 1);
+	for (int s = 0; s < ctx.nSubtrees; s++){
+		ctx.subtreeOrder[next[level[s]]++] = s;
+	}
+}
+
+//' @title initDownstreamPaths
+//' @description next reservoir_dsc downstream cells of every cell (until the outlet) in CSR format with their allocation coefficients,
+//' so water use of reservoirs (routingResHanasaki(), WaterUseInitMeanDemand()) and surface water (SubtractWaterConsumSW())
+//' does not need to follow outflowOrder every day; the part of the path that belongs to a reservoir ends before the next reservoir,
+//' so it needs G_RESAREA after CheckResType()
+void initDownstreamPaths(ModelContext& ctx){
+
+	ctx.downstreamStart.assign(ctx.array_size + 1, 0);
+	ctx.downstreamCells.clear();
+	ctx.downstreamCoeff.clear();
+	ctx.downstreamReservoirEnd.resize(ctx.array_size);
+
+	for (int cell = 0; cell < ctx.array_size; cell++){
+		ctx.downstreamStart[cell] = ctx.downstreamCells.size();
+		ctx.downstreamReservoirEnd[cell] = ctx.downstreamCells.size();
+		bool reservoirPath = true;
+		int i = 0;
+		int downstreamCell = ctx.outflowOrder[cell]; // 1 = first cell, negative = outlet
+		while (i < ctx.reservoir_dsc && downstreamCell > 0) {
+			ctx.downstreamCells.push_back(downstreamCell - 1);
+			ctx.downstreamCoeff.push_back((i < ctx.par.wb.nAllocCoeff) ? ctx.par.wb.allocCoeff(i, cell) : 0.);
+
+			// limits for reservoirs are: 1) 20 routing steps 2) no more donwstream cell (ocean/basin border) 3) another reservoir
+			reservoirPath = reservoirPath && (downstreamCell < ctx.array_size) && (ctx.par.wb.G_RESAREA[downstreamCell-1] == 0);
+			if (reservoirPath) {
+				ctx.downstreamReservoirEnd[cell] = ctx.downstreamCells.size();
+			}
+			// next downstream cell
+			downstreamCell = ctx.outflowOrder[downstreamCell-1];
+			i++;
+		}
+	}
+	ctx.downstreamStart[ctx.array_size] = ctx.downstreamCells.size();
+}
+
+//' @title initWaterUseColours
+//' @description colours for the spatial allocation of water use (SubtractWaterConsumSW()): a cell changes its own storages
+//' and reads the storages of its neighbouring cells, so a cell gets a higher colour than all neighbouring cells
+//' (in both directions) with a smaller cell index; cells of one colour can be simulated in parallel and the colours in order
+//' give the same results as the cells in order of the cell index
+void initWaterUseColours(ModelContext& ctx){
+
+	// neighbour cells as cell index, the first cell of the basin (1 in NeighbouringCells) was never used as neighbour
+	ctx.neighbourCells.assign(8 * (size_t) ctx.array_size, -1);
+	for (int cell = 0; cell < ctx.array_size; cell++){
+		for (int i = 0; i < 8; i++){
+			const double neighbour = ctx.NeighbouringCells(i, cell); // 0 = no neighbour cell in the basin
+			if ((neighbour >= 2) && (neighbour < ctx.array_size + 1)) {
+				ctx.neighbourCells[8 * (size_t) cell + i] = (int) (neighbour - 1);
+			}
+		}
+	}
+
+	vector<int> colour(ctx.array_size, 0);
+	vector<int> minColour(ctx.array_size, 0); // from neighbouring cells with smaller index that have cell as neighbour
+	ctx.nWaterUseColours = 0;
+	for (int cell = 0; cell < ctx.array_size; cell++){
+		const int* neighbours = &ctx.neighbourCells[8 * (size_t) cell];
+		colour[cell] = minColour[cell];
+		for (int i = 0; i < 8; i++){
+			if ((neighbours[i] >= 0) && (neighbours[i] < cell)) {
+				colour[cell] = max(colour[cell], colour[neighbours[i]] + 1);
+			}
+		}
+		for (int i = 0; i < 8; i++){
+			if (neighbours[i] > cell) {
+				minColour[neighbours[i]] = max(minColour[neighbours[i]], colour[cell] + 1);
+			}
+		}
+		ctx.nWaterUseColours = max(ctx.nWaterUseColours, colour[cell] + 1);
+	}
+
+	// cells grouped by colour (CSR), ascending cell index within a colour
+	ctx.waterUseColourStart.assign(ctx.nWaterUseColours + 1, 0);
+	for (int cell = 0; cell < ctx.array_size; cell++){
+		ctx.waterUseColourStart[colour[cell] + 1]++;
+	}
+	for (int c = 0; c < ctx.nWaterUseColours; c++){
+		ctx.waterUseColourStart[c + 1] += ctx.waterUseColourStart[c];
+	}
+	ctx.waterUseColourCells.resize(ctx.array_size);
+	vector<int> next(ctx.waterUseColourStart.begin(), ctx.waterUseColourStart.end() - 1);
+	for (int cell = 0; cell < ctx.array_size; cell++){
+		ctx.waterUseColourCells[next[colour[cell]]++] = cell;
+	}
+}
 
-//Creating working vectors
-NumericVector G_riverOutflow; // only for routing, needs ot be set to zero for every day
-NumericVector QA_river; //has always river outflow from previous time step 
-NumericVector S_river; //has always river inflow from previous time step 
-	
-NumericVector locLake_overflow;
-NumericVector locLake_outflow;
-NumericVector S_locLakeStorage;
-NumericVector locLake_evapo;
-NumericVector locLake_inflow;
-
-NumericVector locWetland_overflow;
-NumericVector locWetland_outflow;
-NumericVector S_locWetlandStorage;
-NumericVector locWetland_evapo;
-NumericVector locWetland_inflow;
-
-NumericVector gloLake_overflow;
-NumericVector gloLake_outflow;
-NumericVector S_gloLakeStorage;
-NumericVector gloLake_evapo;
-NumericVector gloLake_inflow;
-
-NumericVector Res_outflow;
-NumericVector S_ResStorage;
-NumericVector Res_evapo;
-NumericVector Res_inflow;
-NumericVector Res_overflow;
-
-NumericVector gloWetland_overflow;
-NumericVector gloWetland_outflow;
-NumericVector S_gloWetlandStorage;
-NumericVector gloWetland_evapo;
-NumericVector gloWetland_inflow;
-
-NumericMatrix dailyUse; 
-NumericVector G_totalUnsatisfiedUse;
-NumericVector G_actualUse;
-	
-	
 //' @title Initializing of model
-//' @description Vectors and Matrices are initiliazed with the appropiate size for basin (all entries are 0)
-void initializeModel(){
+//' @description Vectors and Matrices of the ModelContext are initiliazed with the appropiate size for basin (all entries are 0)
+void initializeModel(ModelContext& ctx){
 	
-	G_PETnetShort=NumericVector(array_size);
-	G_PETnetLong=NumericVector(array_size);
-
-	daily_prec_to_soil=NumericVector (array_size); 
-	dailySoilPET=NumericVector (array_size); //left energy for evaporation from soil (PET)
-	dailyCanopyEvapo=NumericVector (array_size);
-	dailySnowMelt=NumericVector (array_size); //Snowmelt (flux) per day
-	dailySnowEvapo=NumericVector (array_size); //Sublimation from snow (flux) per day (no changes between sublimation and evaporation)
-	thresh_elev=NumericVector (array_size); //help vector to avoid unlimited snow accumulation in high regions
-	dailyEffPrec=NumericVector (array_size); //Water amount that goes to soil (snowmelt + precipitation (T > 0°C)
-	immediate_runoff=NumericVector (array_size); //Water amount that is transformed directly to surface run-off
-	dailyAET=NumericVector (array_size); // actual evaporation form soil
-	daily_runoff=NumericVector (array_size); //amount of sealed ares in grid [-]
-	soil_water_overflow=NumericVector (array_size); //amount of sealed ares in grid [-]
-	daily_gw_recharge=NumericVector (array_size); 
-	G_dailyLocalSurfaceRunoff=NumericVector (array_size);
-	G_dailyLocalGWRunoff=NumericVector (array_size);
-	G_dailyUseGW=NumericVector (array_size);
+	ctx.G_PETnetShort=NumericVector(ctx.array_size);
+	ctx.G_PETnetLong=NumericVector(ctx.array_size);
+	ctx.dailyPET=NumericVector(ctx.array_size);
+	ctx.dailyPETw=NumericVector(ctx.array_size);
+
+	ctx.daily_prec_to_soil=NumericVector (ctx.array_size); 
+	ctx.dailySoilPET=NumericVector (ctx.array_size); //left energy for evaporation from soil (PET)
+	ctx.dailyCanopyEvapo=NumericVector (ctx.array_size);
+	ctx.dailySnowMelt=NumericVector (ctx.array_size); //Snowmelt (flux) per day
+	ctx.dailySnowEvapo=NumericVector (ctx.array_size); //Sublimation from snow (flux) per day (no changes between sublimation and evaporation)
+	ctx.thresh_elev=NumericVector (ctx.array_size); //help vector to avoid unlimited snow accumulation in high regions
+	ctx.dailyEffPrec=NumericVector (ctx.array_size); //Water amount that goes to soil (snowmelt + precipitation (T > 0°C)
+	ctx.immediate_runoff=NumericVector (ctx.array_size); //Water amount that is transformed directly to surface run-off
+	ctx.dailyAET=NumericVector (ctx.array_size); // actual evaporation form soil
+	ctx.daily_runoff=NumericVector (ctx.array_size); //amount of sealed ares in grid [-]
+	ctx.soil_water_overflow=NumericVector (ctx.array_size); //amount of sealed ares in grid [-]
+	ctx.daily_gw_recharge=NumericVector (ctx.array_size); 
+	ctx.G_dailyLocalSurfaceRunoff=NumericVector (ctx.array_size);
+	ctx.G_dailyLocalGWRunoff=NumericVector (ctx.array_size);
+	ctx.G_dailyUseGW=NumericVector (ctx.array_size);
+	ctx.vectorFallback.assign(ctx.array_size, 0);
+	ctx.laiDay = -1; // see updateLAIdaily()
+	ctx.dailyLai.assign(ctx.array_size, 0.);
+	ctx.laiPrecSum.assign(ctx.array_size, 0.);
+	ctx.laiGrowingStatus.assign(ctx.array_size, 0);
+	ctx.laiDaysSinceStart.assign(ctx.array_size, 0);
 
 	//initiliazing storages 
-	G_canopyWaterContent=NumericVector (array_size); //canopy storage is defined (0 content)
-	G_snow=NumericVector (array_size); //Snow storage for every cell and per day
-	G_snowWaterEquivalent=NumericMatrix (25, array_size); //Snow storage for every subgrid cell and per day
-	G_soilWaterContent=NumericVector (array_size); //soil storage
-	G_groundwater=NumericVector (array_size); // groundwater storage
+	ctx.G_canopyWaterContent=NumericVector (ctx.array_size); //canopy storage is defined (0 content)
+	ctx.G_snow=NumericVector (ctx.array_size); //Snow storage for every cell and per day
+	ctx.G_snowWaterEquivalent=NumericMatrix (25, ctx.array_size); //Snow storage for every subgrid cell and per day
+	initSnowBands(ctx);
+	ctx.G_soilWaterContent=NumericVector (ctx.array_size); //soil storage
+	ctx.G_groundwater=NumericVector (ctx.array_size); // groundwater storage
 	
 	
 	
-	//Creating help vectors to define routing order
-	IntegerVector cellIDs; //cellIDs for actual routing step
-	IntegerVector numbers; //routing steps 
-	IntegerVector numbersSorted; 
-		
 	// ROUTING
 
+	//have to use routing order to be consistent
+	initRoutingSchedule(ctx);
+	initRoutingSubtrees(ctx);
+	initWaterUseColours(ctx);
+
 	//Creating working vectors
-	G_riverOutflow=NumericVector (array_size); // only for routing, needs ot be set to zero for every day
-	QA_river=NumericVector (array_size); //has always river outflow from previous time step 
-	S_river=NumericVector (array_size); //has always river inflow from previous time step 
+	ctx.G_riverOutflow=NumericVector (ctx.array_size); // only for routing, needs ot be set to zero for every day
+	ctx.QA_river=NumericVector (ctx.array_size); //has always river outflow from previous time step 
+	ctx.S_river=NumericVector (ctx.array_size); //has always river inflow from previous time step 
 		
-	locLake_overflow=NumericVector (array_size);
-	locLake_outflow=NumericVector (array_size);
-	S_locLakeStorage=NumericVector (array_size);
-	locLake_evapo=NumericVector (array_size);
-	locLake_inflow=NumericVector (array_size);
-
-	locWetland_overflow=NumericVector (array_size);
-	locWetland_outflow=NumericVector (array_size);
-	S_locWetlandStorage=NumericVector (array_size);
-	locWetland_evapo=NumericVector (array_size);
-	locWetland_inflow=NumericVector (array_size);
-
-	gloLake_overflow=NumericVector (array_size);
-	gloLake_outflow=NumericVector (array_size);
-	S_gloLakeStorage=NumericVector (array_size);
-	gloLake_evapo=NumericVector (array_size);
-	gloLake_inflow=NumericVector (array_size);
-
-	Res_outflow=NumericVector (array_size);
-	S_ResStorage=NumericVector (array_size);
-	Res_evapo=NumericVector (array_size);
-	Res_inflow=NumericVector (array_size);
-	Res_overflow=NumericVector (array_size);
-
-	gloWetland_overflow=NumericVector (array_size);
-	gloWetland_outflow=NumericVector (array_size);
-	S_gloWetlandStorage=NumericVector (array_size);
-	gloWetland_evapo=NumericVector (array_size);
-	gloWetland_inflow=NumericVector (array_size);
+	ctx.locLake_overflow=NumericVector (ctx.array_size);
+	ctx.locLake_outflow=NumericVector (ctx.array_size);
+	ctx.S_locLakeStorage=NumericVector (ctx.array_size);
+	ctx.locLake_evapo=NumericVector (ctx.array_size);
+	ctx.locLake_inflow=NumericVector (ctx.array_size);
+
+	ctx.locWetland_overflow=NumericVector (ctx.array_size);
+	ctx.locWetland_outflow=NumericVector (ctx.array_size);
+	ctx.S_locWetlandStorage=NumericVector (ctx.array_size);
+	ctx.locWetland_evapo=NumericVector (ctx.array_size);
+	ctx.locWetland_inflow=NumericVector (ctx.array_size);
+
+	ctx.gloLake_overflow=NumericVector (ctx.array_size);
+	ctx.gloLake_outflow=NumericVector (ctx.array_size);
+	ctx.S_gloLakeStorage=NumericVector (ctx.array_size);
+	ctx.gloLake_evapo=NumericVector (ctx.array_size);
+	ctx.gloLake_inflow=NumericVector (ctx.array_size);
+
+	ctx.Res_outflow=NumericVector (ctx.array_size);
+	ctx.S_ResStorage=NumericVector (ctx.array_size);
+	ctx.Res_evapo=NumericVector (ctx.array_size);
+	ctx.Res_inflow=NumericVector (ctx.array_size);
+	ctx.Res_overflow=NumericVector (ctx.array_size);
+
+	ctx.gloWetland_overflow=NumericVector (ctx.array_size);
+	ctx.gloWetland_outflow=NumericVector (ctx.array_size);
+	ctx.S_gloWetlandStorage=NumericVector (ctx.array_size);
+	ctx.gloWetland_evapo=NumericVector (ctx.array_size);
+	ctx.gloWetland_inflow=NumericVector (ctx.array_size);
 	
-	dailyUse=NumericMatrix (2, array_size);
-	G_totalUnsatisfiedUse=NumericVector (array_size);
-	G_actualUse=NumericVector (array_size);
+	ctx.dailyUse=WaterUseDay ();
+	ctx.G_totalUnsatisfiedUse=NumericVector (ctx.array_size);
+	ctx.waterUseDeficit.assign((size_t) ctx.array_size * ctx.reservoir_dsc, 0.);
+	ctx.waterUseKeep.assign(ctx.array_size, 1.);
+	ctx.G_actualUse=NumericVector (ctx.array_size);
 	
 }
 
+//' @title Initializing of simulation period
+//' @description calendar information (year, month, day, DOY) of the simulation period is stored in the ModelContext,
+//' so that the simulation itself does not need Rcpp::Date (which uses the R API and is not thread-safe)
+void initSimPeriod(ModelContext& ctx, DateVector SimPeriod){
+	
+	ctx.ndays = SimPeriod.length();
+	ctx.SimYear.resize(ctx.ndays);
+	ctx.SimMonth.resize(ctx.ndays);
+	ctx.SimDay.resize(ctx.ndays);
+	ctx.SimDOY.resize(ctx.ndays);
+	
+	for (int time = 0; time < ctx.ndays; time++){
+		Date SimDate = SimPeriod[time];
+		ctx.SimYear[time] = SimDate.getYear();
+		ctx.SimMonth[time] = SimDate.getMonth();
+		ctx.SimDay[time] = SimDate.getDay();
+		ctx.SimDOY[time] = min(SimDate.getYearday(), 365); //1-365 - small differences in computed PET will arrive when leap year (29.02) is neglected in model settings and long/shortwave downward radiation is estimated
+		// 31 and 30 december is always set to 365 because estimation of longwave and shortwave radiation allows only values between 1-365
+		// could be improved in the future that 29.02 is set to 60.5 if it occurs --> own DOY-function needs to be implemented therfore! e.g. https://mariusbancila.ro/blog/2017/08/03/computing-day-of-year-in-c/
+	}
+	
+	WaterUseInitSchedule(ctx); // water use of every month of the simulation period
+}
 
-
-
+//' @title Initializing of output periods
+//' @description defines the row of the output matrices for every day of the simulation period (see initSimPeriod()),
+//' daily output or mean values of months, years or of the whole simulation period
+//' @param ctx ModelContext of the model
+//' @param outputTimestep 0 (daily), 1 (monthly), 2 (yearly) or 3 (long-term mean)
+void initOutputPeriods(ModelContext& ctx, int outputTimestep){
+	
+	ctx.outputTimestep = outputTimestep;
+	ctx.outputPeriod.resize(ctx.ndays);
+	ctx.outputPeriodDays.clear();
+	
+	int lastKey = -1;
+	for (int time = 0; time < ctx.ndays; time++){
+		int key = time; // daily
+		if (outputTimestep == 1) {
+			key = ctx.SimYear[time] * 12 + ctx.SimMonth[time];
+		} else if (outputTimestep == 2) {
+			key = ctx.SimYear[time];
+		} else if (outputTimestep == 3) {
+			key = 0;
+		}
+		
+		if ((time == 0) || (key != lastKey)) {
+			ctx.outputPeriodDays.push_back(0);
+			lastKey = key;
+		}
+		ctx.outputPeriod[time] = ctx.outputPeriodDays.size() - 1;
+		
+		if ((ctx.GapYearType == 1) && (ctx.SimDay[time] == 29) && (ctx.SimMonth[time] == 2)){
+			continue; // 29.02 is not simulated
+		}
+		ctx.outputPeriodDays.back()++;
+	}
+	ctx.nOutputPeriods = ctx.outputPeriodDays.size();
+}
@@ -1,5 +1,6 @@
 #include <Rcpp.h>
 #include <math.h>
+#include <algorithm>
 #include "routing.h"
 #include "ModelTools.h"
 #include "initializeModel.h"
@@ -28,15 +29,9 @@ using namespace std;
 //int numberOfDaysInYear(int year);
 
 
-void CheckResType();
-
-void setLakeWetlandToMaximum(NumericVector S_locLakeStorage, NumericVector S_locWetlandStorage,
-							NumericVector S_gloLakeStorage, NumericVector S_ResStorage,
-							NumericVector S_gloWetlandStorage);
-
-
 //' @title routing
 //' @description this function includes als routing modules
+//' @param modelContext model created with initModelContext()
 //' @param SimPeriod Datevector of Simulationperiod
 //' @param surfaceRunoff run-off from surface contributing to river network
 //' @param GroundwaterRunoff run-off from groundwater contributing to river network
@@ -44,273 +39,447 @@ void setLakeWetlandToMaximum(NumericVector S_locLakeStorage, NumericVector S_loc
 //' @param Prec Precipitation as NumericMatrix in mm/d
 //' @export
 // [[Rcpp::export]]
-List routing(DateVector SimPeriod, NumericMatrix surfaceRunoff, NumericMatrix GroundwaterRunoff,
+List routing(SEXP modelContext, DateVector SimPeriod, NumericMatrix surfaceRunoff, NumericMatrix GroundwaterRunoff,
 			NumericMatrix PETw, NumericMatrix Prec){
+	ModelContext& ctx = getModelContext(modelContext);
+	return(routing(ctx, SimPeriod, surfaceRunoff, GroundwaterRunoff, PETw, Prec));
+}
 
-	const int ndays = SimPeriod.length();
-	const double landSize = sumVector(GAREA); //basinArea (only landfraction is considered)
+// routing of the model defined in ctx
+List routing(ModelContext& ctx, DateVector SimPeriod, NumericMatrix surfaceRunoff, NumericMatrix GroundwaterRunoff,
+			NumericMatrix PETw, NumericMatrix Prec){
 
-	Date startDate = SimPeriod[0];
-	int startYear = startDate.getYear();
+	initSimPeriod(ctx, SimPeriod);
 
-	CheckResType();
+	RoutingOutput out;
+	initRoutingOutput(ctx, out);
+	simulateRouting(ctx, out, OutputMatrix(surfaceRunoff), OutputMatrix(GroundwaterRunoff), OutputMatrix(PETw), ForcingMatrix(Prec)); // same layout as output of createWaterBalance() in runModel()
 
-	//is now done in runWarmUp()
-	//setLakeWetlandToMaximum(S_locLakeStorage, S_locWetlandStorage,
-	//						S_gloLakeStorage, S_ResStorage, S_gloWetlandStorage);
+	return(getRoutingOutput(ctx, out));
+}
+
+// output matrices of the routing with their names in the output list (see getRoutingOutput())
+vector< pair<string, OutputMatrix*> > getRoutingOutputTable(RoutingOutput& out){
+
+	vector< pair<string, OutputMatrix*> > table = {
+		{"WaterUseSW", &out.ActualUseSW},
+		{"River$RiverStorage", &out.RiverStorage},
+		{"River$InflowUpstream", &out.InflowUpstream2write},
+		{"River$RiverAvail", &out.RiverAvail},
+		{"locLake$Overflow", &out.OverflowlocLake},
+		{"locLake$Outflow", &out.OutflowlocLake},
+		{"locLake$Evapo", &out.EvapolocLake},
+		{"locLake$Storage", &out.StoragelocLake},
+		{"locLake$Inflow", &out.InflowlocLake},
+		{"locWetland$Overflow", &out.OverflowlocWetland},
+		{"locWetland$Outflow", &out.OutflowlocWetland},
+		{"locWetland$Evapo", &out.EvapolocWetland},
+		{"locWetland$Storage", &out.StoragelocWetland},
+		{"locWetland$Inflow", &out.InflowlocWetland},
+		{"gloLake$Overflow", &out.OverflowgloLake},
+		{"gloLake$Outflow", &out.OutflowgloLake},
+		{"gloLake$Evapo", &out.EvapogloLake},
+		{"gloLake$Storage", &out.StoragegloLake},
+		{"gloLake$Inflow", &out.InflowgloLake},
+		{"Res$Overflow", &out.OverflowRes},
+		{"Res$Outflow", &out.OutflowRes},
+		{"Res$Evapo", &out.EvapoRes},
+		{"Res$Storage", &out.StorageRes},
+		{"Res$Inflow", &out.InflowRes},
+		{"gloWetland$Overflow", &out.OverflowgloWetland},
+		{"gloWetland$Outflow", &out.OutflowgloWetland},
+		{"gloWetland$Evapo", &out.EvapogloWetland},
+		{"gloWetland$Storage", &out.StoragegloWetland},
+		{"gloWetland$Inflow", &out.InflowgloWetland}
+	};
+	return(table);
+}
 
+// allocates output of the routing (uses R API -> only in main thread)
+// output that is not requested in spec is not allocated, so it is not written during the simulation (see saveDay())
+void initRoutingOutput(ModelContext& ctx, RoutingOutput& out, const OutputSpec& spec){
+
+	initOutputPeriods(ctx, spec.timestep);
+	const int nRows = ctx.nOutputPeriods; // days, months or years
+
+	if (spec.keep("River$Discharge")){
+		out.Discharge = NumericVector(nRows);
+	}
+	if (spec.keep("River$StatVelocity")){
+		out.RiverVelocityStat = NumericVector(nRows);
+	}
+
+	vector< pair<string, OutputMatrix*> > table = getRoutingOutputTable(out);
+	for (size_t i = 0; i < table.size(); i++){
+		if (spec.keep(table[i].first)){
+			*table[i].second = OutputMatrix(nRows, ctx.array_size);
+		}
+	}
+}
+
+// routing of one cell for one day: local lakes -> local wetlands -> global lakes -> reservoirs -> global wetlands -> river
+// only states of the cell itself are changed, so it can be called in parallel for cells that do not depend on each other
+// UpstreamOutflow: sum of outflow of upstream cells in the actual day (see getUpstreamInflow())
+// returns outflow of the cell [mm*km²]
+// PrecWater, PETWater: precipitation and PET of open water [mm/day], LandRunoff: surface and groundwater run-off from land [mm/day]
+double routingCell(ModelContext& ctx, RoutingOutput& out, int day, int cell, double UpstreamOutflow,
+			double PrecWater, double PETWater, double LandRunoff,
+			const vector<double>& MeanDemand, vector<double>& K_release, double landSize){
+
+	double InflowUpstream = 0.0;
 	double out_loclake;
 	double out_locwet;
 	double out_glolake;
 	double out_glowet;
 	double out_res;
-	double RiverInflow;
-	double RoutedOutflowCell;
 
-	NumericVector Discharge (ndays);
-	NumericVector RiverVelocityStat (ndays);
 
-	//Zustände die gespeichert werden
-	NumericMatrix RiverAvail(ndays, array_size); //
-	NumericMatrix InflowUpstream2write(ndays, array_size); //
+	const double LandInflow = LandRunoff * ctx.par.wb.GAREA[cell] * ctx.par.wb.landfrac[cell]; // mm * km²
 
-
-	//local Lakes
-	NumericMatrix OverflowlocLake(ndays, array_size); // special overflow, when S > Smax
-	NumericMatrix OutflowlocLake(ndays, array_size);  // total outflow
-	NumericMatrix StoragelocLake(ndays, array_size);  // storage of lake
-	NumericMatrix EvapolocLake(ndays, array_size);    // Evaporatiom from Lake
-	NumericMatrix InflowlocLake(ndays, array_size);   // Inflow to Lake
+	//routing process within cell - could also be part of waterbalance or otherwise - ground water routing could also be part of routing!
+	// local lakes
+	if (ctx.par.wb.G_LOCLAK[cell] > 0) {
+		out_loclake = routingLocalWaterBodies<LOCAL_LAKE>(ctx, cell, PrecWater, PETWater, LandInflow); // mm * km²
+	} else {
+		out_loclake = LandInflow; // mm * km²
+	}
 
 	//local wetlands
-	NumericMatrix OverflowlocWetland(ndays, array_size); // special overflow, when S > Smax
-	NumericMatrix OutflowlocWetland(ndays, array_size);  // total outflow
-	NumericMatrix StoragelocWetland(ndays, array_size);  // storage of Wetland
-	NumericMatrix EvapolocWetland(ndays, array_size);    // Evaporatiom from Wetland
-	NumericMatrix InflowlocWetland(ndays, array_size);   // Inflow to Wetland
-
-	//global Lakes
-	NumericMatrix OverflowgloLake(ndays, array_size); // special overflow, when S > Smax
-	NumericMatrix OutflowgloLake(ndays, array_size);  // total outflow
-	NumericMatrix StoragegloLake(ndays, array_size);  // storage of lake
-	NumericMatrix EvapogloLake(ndays, array_size);    // Evaporatiom from Lake
-	NumericMatrix InflowgloLake(ndays, array_size);   // Inflow to Lake
-
-	//reservoirs
-	NumericMatrix OutflowRes(ndays, array_size);  // total outflow
-	NumericMatrix StorageRes(ndays, array_size);  // storage of Reservoir
-	NumericMatrix EvapoRes(ndays, array_size);    // Evaporatiom from Reservoir
-	NumericMatrix InflowRes(ndays, array_size);   // Inflow to Reservoir  Res_overflow
-	NumericMatrix OverflowRes(ndays, array_size); // overflow from Reservoir when precipitation above Reservoir and Inflow are to high
-	NumericVector K_release(array_size); //release factor for reservoirs
-
-	//global wetlands
-	NumericMatrix OverflowgloWetland(ndays, array_size); // special overflow, when S > Smax
-	NumericMatrix OutflowgloWetland(ndays, array_size);  // total outflow
-	NumericMatrix StoragegloWetland(ndays, array_size);  // storage of Wetland
-	NumericMatrix EvapogloWetland(ndays, array_size);    // Evaporatiom from Wetland
-	NumericMatrix InflowgloWetland(ndays, array_size);   // Inflow to Wetland
-
-	//River
-	NumericMatrix RiverStorage(ndays, array_size); // special overflow, when S > Smax
-
-	//WaterUse
-	NumericMatrix ActualUseSW (ndays, array_size);
-
-	int cell;
-	double InflowUpstream;
-	int downstreamcell;
-	double riverVelocity;
-
-	//have to use routing order to be consistent
-	numbers =  findUniqueValues(routeOrder); //finding unique values in route order (ascending) => routingSteps
-	numbersSorted = sortIt(numbers);
+	if (ctx.par.wb.G_LOCWET[cell] > 0) {
+		out_locwet = routingLocalWaterBodies<LOCAL_WETLAND>(ctx, cell, PrecWater, PETWater, out_loclake);
+	} else {
+		out_locwet = out_loclake; // mm * km²
+	}
 
-	// If K_release is necessary (ie we use Hanasaki algrithm) then initialize it
-	if (ReservoirType != 1) 
-	{
-		for (int cell = 0; cell < array_size; cell++)
-		{
-			double MIN_RELEASE = 0.1;
-			double KM3_to_MMKM2 = 1000. * 1000.;
-			K_release[cell] = max(S_ResStorage[cell] / (G_STORAGE_CAPACITY[cell] * KM3_to_MMKM2 ), MIN_RELEASE );
-		}
 
+	// water that comes out of the system of local lakes/wetlands
+	// is inflow into the river and is being routed through global lakes and wetlands
+
+	//if cell is not "head basin" then grap inflowFrom Upstream Information
+	if (ctx.routeOrder[cell] > 1){
+		InflowUpstream = UpstreamOutflow;
+		saveDayCell(ctx, out.InflowUpstream2write, day, cell, UpstreamOutflow);
 	}
-	for (int day = 0; day < ndays; day++){
 
-		if (day % 100 == 0) {
-			Rcpp::checkUserInterrupt(); // check for interrupt every 100 iterations
-		}
-		Date SimDate = SimPeriod[day];
 
-		//calculate Net Abstraction in mm*km² / day for every cell for groundwater and surface water
-		// irrigation is considered as well as transfer of water for bigger cities (domestic)
-		int year = SimDate.getYear();
-		int month = SimDate.getMonth();
-		int dayDate = SimDate.getDay();
+	const double RiverInflow = InflowUpstream + out_locwet; // mm * km²
+
+	//global lakes
+	if (ctx.par.wb.G_LAKAREA[cell] > 0) {
+		out_glolake = routingGlobalLakes(ctx, cell, PrecWater, PETWater, RiverInflow,
+					  ctx.gloLake_overflow, ctx.gloLake_outflow , ctx.S_gloLakeStorage,
+					  ctx.gloLake_evapo, ctx.gloLake_inflow); // mm * km²
+	} else {
+		out_glolake = RiverInflow; // mm * km²
+	}
 
-		NumericVector MeanDemand = WaterUseCalcMeanDemandDaily(year, GapYearType);
+	//reserviors
+	if (ctx.par.wb.G_RESAREA[cell] > 0) {
+		out_res = routingResHanasaki(ctx, day, cell, PETWater, PrecWater, out_glolake,
+				ctx.Res_outflow, ctx.Res_overflow, ctx.S_ResStorage, ctx.Res_evapo, ctx.Res_inflow,
+				ctx.dailyUse, MeanDemand, K_release);
+	} else {
+		out_res = out_glolake;
+	}
 
-		if (GapYearType == 1) { //avoid somulation of the 29.02 to compare modelling result to WG3
-			if ((dayDate == 29) && (month == 2)){
-				continue;
+	//out_res = out_glolake;
+
+	// global wetlands
+	if (ctx.par.wb.G_GLOWET[cell] > 0) {
+		out_glowet =  routingGlobalWetlands(ctx, cell, PrecWater, PETWater, out_res,
+					 ctx.gloWetland_overflow, ctx.gloWetland_outflow, ctx.S_gloWetlandStorage,
+					 ctx.gloWetland_evapo, ctx.gloWetland_inflow);
+	} else {
+		out_glowet = out_res;
+	}
+
+	//river segment
+	const double riverVelocity = getRiverVelocity(ctx, ctx.flowVelocityType, cell, out_glowet); // 0 = const, other=variable [km/day]
+	const double RoutedOutflowCell = routingRiver(ctx, cell, riverVelocity, out_glowet,
+						ctx.QA_river, ctx.S_river); // mm*km² (pulled by downstream cell from QA_river)
+
+	//getting routed river in river network
+	saveDayCell(ctx, out.RiverAvail, day, cell, RoutedOutflowCell / landSize); //mm;
+	if (ctx.outflowOrder[cell] < 0) { //end of basin is reached
+		saveDayValue(ctx, out.Discharge, day, RoutedOutflowCell / landSize); //mm
+		saveDayValue(ctx, out.RiverVelocityStat, day, riverVelocity / 86.4); // m/s
+	}
+
+	return(RoutedOutflowCell);
+}
+
+// saves states and fluxes of one cell for one day (simulateRoutingBlocked() does not simulate day by day for the whole basin)
+void saveRoutingStates(ModelContext& ctx, RoutingOutput& out, int day, int cell){
+
+	saveDayCell(ctx, out.OverflowlocLake, day, cell, ctx.locLake_overflow[cell]);
+	saveDayCell(ctx, out.OutflowlocLake, day, cell, ctx.locLake_outflow[cell]);
+	saveDayCell(ctx, out.StoragelocLake, day, cell, ctx.S_locLakeStorage[cell]);
+	saveDayCell(ctx, out.EvapolocLake, day, cell, ctx.locLake_evapo[cell]);
+	saveDayCell(ctx, out.InflowlocLake, day, cell, ctx.locLake_inflow[cell]);
+
+	saveDayCell(ctx, out.OverflowlocWetland, day, cell, ctx.locWetland_overflow[cell]);
+	saveDayCell(ctx, out.OutflowlocWetland, day, cell, ctx.locWetland_outflow[cell]);
+	saveDayCell(ctx, out.StoragelocWetland, day, cell, ctx.S_locWetlandStorage[cell]);
+	saveDayCell(ctx, out.EvapolocWetland, day, cell, ctx.locWetland_evapo[cell]);
+	saveDayCell(ctx, out.InflowlocWetland, day, cell, ctx.locWetland_inflow[cell]);
+
+	saveDayCell(ctx, out.OverflowgloLake, day, cell, ctx.gloLake_overflow[cell]);
+	saveDayCell(ctx, out.OutflowgloLake, day, cell, ctx.gloLake_outflow[cell]);
+	saveDayCell(ctx, out.StoragegloLake, day, cell, ctx.S_gloLakeStorage[cell]);
+	saveDayCell(ctx, out.EvapogloLake, day, cell, ctx.gloLake_evapo[cell]);
+	saveDayCell(ctx, out.InflowgloLake, day, cell, ctx.gloLake_inflow[cell]);
+
+	saveDayCell(ctx, out.OutflowRes, day, cell, ctx.Res_outflow[cell]);
+	saveDayCell(ctx, out.StorageRes, day, cell, ctx.S_ResStorage[cell]);
+	saveDayCell(ctx, out.EvapoRes, day, cell, ctx.Res_evapo[cell]);
+	saveDayCell(ctx, out.InflowRes, day, cell, ctx.Res_inflow[cell]);
+	saveDayCell(ctx, out.OverflowRes, day, cell, ctx.Res_overflow[cell]);
+
+	saveDayCell(ctx, out.OverflowgloWetland, day, cell, ctx.gloWetland_overflow[cell]);
+	saveDayCell(ctx, out.OutflowgloWetland, day, cell, ctx.gloWetland_outflow[cell]);
+	saveDayCell(ctx, out.StoragegloWetland, day, cell, ctx.S_gloWetlandStorage[cell]);
+	saveDayCell(ctx, out.EvapogloWetland, day, cell, ctx.gloWetland_evapo[cell]);
+	saveDayCell(ctx, out.InflowgloWetland, day, cell, ctx.gloWetland_inflow[cell]);
+
+	saveDayCell(ctx, out.RiverStorage, day, cell, ctx.S_river[cell]);
+}
+
+// saves states and fluxes of all cells for one day, matrices that are not allocated are skipped (see saveDay())
+void saveRoutingDay(ModelContext& ctx, RoutingOutput& out, int day){
+
+	saveDay(ctx, out.ActualUseSW, day, ctx.G_actualUse);
+
+	//Save all states and fluxes to matrix
+	saveDay(ctx, out.OverflowlocLake, day, ctx.locLake_overflow); // mm*km² -> (GAREA * G_LOCLAK / 100.); //mm
+	saveDay(ctx, out.OutflowlocLake, day, ctx.locLake_outflow); // mm*km² - >(GAREA * G_LOCLAK / 100.); //mm
+	saveDay(ctx, out.StoragelocLake, day, ctx.S_locLakeStorage); // mm*km²- >(GAREA * G_LOCLAK / 100.); //mm
+	saveDay(ctx, out.EvapolocLake, day, ctx.locLake_evapo); // mm*km²- >(GAREA * G_LOCLAK / 100.); //mm
+	saveDay(ctx, out.InflowlocLake, day, ctx.locLake_inflow); // mm*km²- >(GAREA * G_LOCLAK / 100.); //mm
+
+	saveDay(ctx, out.OverflowlocWetland, day, ctx.locWetland_overflow); // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
+	saveDay(ctx, out.OutflowlocWetland, day, ctx.locWetland_outflow); // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
+	saveDay(ctx, out.StoragelocWetland, day, ctx.S_locWetlandStorage); // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
+	saveDay(ctx, out.EvapolocWetland, day, ctx.locWetland_evapo); // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
+	saveDay(ctx, out.InflowlocWetland, day, ctx.locWetland_inflow); // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
+
+	saveDay(ctx, out.OverflowgloLake, day, ctx.gloLake_overflow); // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
+	saveDay(ctx, out.OutflowgloLake, day, ctx.gloLake_outflow); // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
+	saveDay(ctx, out.StoragegloLake, day, ctx.S_gloLakeStorage); // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
+	saveDay(ctx, out.EvapogloLake, day, ctx.gloLake_evapo); // mm
+	saveDay(ctx, out.InflowgloLake, day, ctx.gloLake_inflow); // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
+
+	saveDay(ctx, out.OutflowRes, day, ctx.Res_outflow); // (GAREA * G_LOCWET / 100.); //mm
+	saveDay(ctx, out.StorageRes, day, ctx.S_ResStorage); // (GAREA * G_LOCWET / 100.); //mm
+	saveDay(ctx, out.EvapoRes, day, ctx.Res_evapo); // (GAREA * G_LOCWET / 100.); //mm
+	saveDay(ctx, out.InflowRes, day, ctx.Res_inflow); // (GAREA * G_LOCWET / 100.); //mm
+	saveDay(ctx, out.OverflowRes, day, ctx.Res_overflow); // (GAREA * G_LOCWET / 100.); //mm
+
+	saveDay(ctx, out.OverflowgloWetland, day, ctx.gloWetland_overflow); // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
+	saveDay(ctx, out.OutflowgloWetland, day, ctx.gloWetland_outflow); // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
+	saveDay(ctx, out.StoragegloWetland, day, ctx.S_gloWetlandStorage); // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
+	saveDay(ctx, out.EvapogloWetland, day, ctx.gloWetland_evapo); // mm
+	saveDay(ctx, out.InflowgloWetland, day, ctx.gloWetland_inflow); // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
+
+	saveDay(ctx, out.RiverStorage, day, ctx.S_river);
+}
+
+// routing with temporal blocking, only for simulations without water use (nothing is abstracted from neighbouring or downstream cells):
+// every subtree of the network (see initRoutingSubtrees()) is simulated for a block of days, so its states stay in cache,
+// then the outflow of the block is passed to the downstream subtree; subtrees of one level are simulated in parallel
+// results are the same as simulated day by day (same order of cells and summation of inflow)
+void simulateRoutingBlocked(ModelContext& ctx, RoutingOutput& out, const OutputMatrix& surfaceRunoff, const OutputMatrix& GroundwaterRunoff,
+			const OutputMatrix& PETw, const ForcingMatrix& Prec, vector<double>& K_release, double landSize){
+
+	const int ndays = ctx.ndays;
+	const int blockLength = 365; // days
+#ifdef _OPENMP
+	const int nThreads = ctx.nThreadsRouting;
+#endif
+
+	// mean demand of reservoirs only changes with the year
+	const int startYear = ctx.SimYear[0];
+	vector< vector<double> > MeanDemandYear(ctx.SimYear[ndays - 1] - startYear + 1);
+	for (int y = 0; y < (int) MeanDemandYear.size(); y++){
+		MeanDemandYear[y] = WaterUseCalcMeanDemandDaily(ctx, startYear + y, ctx.GapYearType);
+	}
+
+	vector<double> subtreeOutflow(ctx.nSubtrees * blockLength); // outflow of the outlet of every subtree for the days of the actual block
+	ctx.G_actualUse.fill(0); //no water use
+
+	for (int blockStart = 0; blockStart < ndays; blockStart += blockLength){
+		const int blockEnd = min(blockStart + blockLength, ndays);
+
+		if (ctx.checkInterrupt) {
+			Rcpp::checkUserInterrupt();
+		}
+
+		for (int l = 0; l < ctx.nSubtreeLevels; l++){
+#ifdef _OPENMP
+			#pragma omp parallel for schedule(dynamic) num_threads(nThreads) if (nThreads > 1)
+#endif
+			for (int j = ctx.subtreeLevelStart[l]; j < ctx.subtreeLevelStart[l+1]; j++){
+				const int subtree = ctx.subtreeOrder[j];
+				const int subtreeOutlet = ctx.subtreeCells[ctx.subtreeStart[subtree+1] - 1];
+
+				for (int day = blockStart; day < blockEnd; day++){
+					if ((ctx.GapYearType == 1) && (ctx.SimDay[day] == 29) && (ctx.SimMonth[day] == 2)) {
+						continue; //avoid somulation of the 29.02 to compare modelling result to WG3
+					}
+					const vector<double>& MeanDemand = MeanDemandYear[ctx.SimYear[day] - startYear];
+
+					for (int k = ctx.subtreeStart[subtree]; k < ctx.subtreeStart[subtree+1]; k++){
+						const int cell = ctx.subtreeCells[k];
+
+						// same as getUpstreamInflow(), but outflow of other subtrees is taken from the block
+						double UpstreamOutflow = 0.;
+						for (int i = ctx.upstreamStart[cell]; i < ctx.upstreamStart[cell + 1]; i++){
+							const int upstreamCell = ctx.upstreamCells[i];
+							if (ctx.subtreeOf[upstreamCell] == subtree) {
+								UpstreamOutflow += ctx.QA_river[upstreamCell];
+							} else {
+								UpstreamOutflow += subtreeOutflow[ctx.subtreeOf[upstreamCell] * blockLength + day - blockStart];
+							}
+						}
+						ctx.G_riverOutflow[cell] = UpstreamOutflow;
+
+						const double RoutedOutflowCell = routingCell(ctx, out, day, cell, UpstreamOutflow, Prec(day, cell), PETw(day, cell),
+											GroundwaterRunoff(day, cell) + surfaceRunoff(day, cell), MeanDemand, K_release, landSize);
+						saveRoutingStates(ctx, out, day, cell);
+
+						if (cell == subtreeOutlet) {
+							subtreeOutflow[subtree * blockLength + day - blockStart] = RoutedOutflowCell;
+						}
+					}
+				}
 			}
 		}
+	}
+}
 
-		WaterUseCalcDaily(waterUseType, dailyUse, year, month, startYear, Info_GW, Info_SW, Info_TF); // first row = GW, second row = SW
+// basinArea (only landfraction is considered) - sumVector() would copy the R vector
+double getLandSize(ModelContext& ctx){
+	double landSize = 0;
+	for (int cell = 0; cell < ctx.array_size; cell++){
+		landSize += ctx.par.wb.GAREA[cell];
+	}
+	return(landSize);
+}
 
-		G_actualUse.fill(0); //clean up actual use from Surface Water Bodies
-		G_riverOutflow.fill(0); //to clean up routing network befor starting simulation of actual day
+// release factor for reservoirs at the start of the simulation period
+vector<double> initReleaseFactor(ModelContext& ctx){
 
-		for (int n = 0; n < numbers.length(); n++){
-			int number = numbersSorted[n];
-			cellIDs = findNumberInVector(number, routeOrder); //finding cells that have to be calculated in actual routing step -> starts from 0
-			for (int i=0; i < cellIDs.length(); i++) {
-				cell = cellIDs[i];
-				InflowUpstream = 0.0;
+	vector<double> K_release(ctx.array_size);
 
+	// If K_release is necessary (ie we use Hanasaki algrithm) then initialize it
+	if (ctx.ReservoirType != 1) 
+	{
+		for (int cell = 0; cell < ctx.array_size; cell++)
+		{
+			double MIN_RELEASE = 0.1;
+			double KM3_to_MMKM2 = 1000. * 1000.;
+			K_release[cell] = max(ctx.S_ResStorage[cell] / (ctx.par.wb.G_STORAGE_CAPACITY[cell] * KM3_to_MMKM2 ), MIN_RELEASE );
+		}
 
-				const double PrecWater = Prec(day, cell);
-				const double PETWater = PETw(day, cell);
-				const double LandInflow = (GroundwaterRunoff(day, cell) + surfaceRunoff(day, cell))* GAREA[cell] * landfrac[cell]; // mm * km²
+	}
+	return(K_release);
+}
 
-				//routing process within cell - could also be part of waterbalance or otherwise - ground water routing could also be part of routing!
-				// local lakes
-				if (G_LOCLAK[cell] > 0) {
-					out_loclake = routingLocalWaterBodies(0, cell, PrecWater, PETWater, LandInflow,
-								S_locLakeStorage, locLake_overflow, locLake_outflow, locLake_evapo, locLake_inflow,
-								S_locWetlandStorage, locWetland_overflow, locWetland_outflow, locWetland_evapo, locWetland_inflow); // mm * km²
-				} else {
-					out_loclake = LandInflow; // mm * km²
-				}
+// simulation of the routing for the simulation period (initSimPeriod()) - does not use the R API
+void simulateRouting(ModelContext& ctx, RoutingOutput& out, const OutputMatrix& surfaceRunoff, const OutputMatrix& GroundwaterRunoff,
+			const OutputMatrix& PETw, const ForcingMatrix& Prec){
 
-				//local wetlands
-				if (G_LOCWET[cell] > 0) {
-					out_locwet = routingLocalWaterBodies(1, cell, PrecWater, PETWater, out_loclake,
-								S_locLakeStorage, locLake_overflow, locLake_outflow, locLake_evapo, locLake_inflow,
-								S_locWetlandStorage, locWetland_overflow, locWetland_outflow, locWetland_evapo, locWetland_inflow);
-				} else {
-					out_locwet = out_loclake; // mm * km²
-				}
+	const int ndays = ctx.ndays;
+	const double landSize = getLandSize(ctx);
 
+	CheckResType(ctx);
+	initDownstreamPaths(ctx); // downstream cells of reservoirs (after CheckResType())
+	WaterUseInitMeanDemand(ctx); // mean demand of reservoirs
 
-				// water that comes out of the system of local lakes/wetlands
-				// is inflow into the river and is being routed through global lakes and wetlands
+	//is now done in runWarmUp()
+	//setLakeWetlandToMaximum(S_locLakeStorage, S_locWetlandStorage,
+	//						S_gloLakeStorage, S_ResStorage, S_gloWetlandStorage);
 
-				//if cell is not "head basin" then grap inflowFrom Upstream Information
-				if (routeOrder[cell] > 1){
-					InflowUpstream = G_riverOutflow[cell];
-					InflowUpstream2write(day,cell) = G_riverOutflow[cell];
-				}
+	// cells of one routing step can be simulated in parallel, because inflow from upstream cells is pulled (getUpstreamInflow())
+	// and all other states are only written for the cell itself -> results are independent of the number of threads
+#ifdef _OPENMP
+	const int nThreads = ctx.routeStepsIndependent ? ctx.nThreadsRouting : 1;
+#endif
 
+	vector<double> K_release = initReleaseFactor(ctx); //release factor for reservoirs
 
-				RiverInflow = InflowUpstream + out_locwet; // mm * km²
+	// without water use, cells only exchange water via the river network -> subtrees of the network can be simulated for blocks of days
+	if (ctx.routingBlocked && (ctx.waterUseType == 0)) {
+		simulateRoutingBlocked(ctx, out, surfaceRunoff, GroundwaterRunoff, PETw, Prec, K_release, landSize);
+		return;
+	}
 
-				//global lakes
-				if (G_LAKAREA[cell] > 0) {
-					out_glolake = routingGlobalLakes(cell, PrecWater, PETWater, RiverInflow,
-								  gloLake_overflow, gloLake_outflow , S_gloLakeStorage,
-								  gloLake_evapo, gloLake_inflow); // mm * km²
-				} else {
-					out_glolake = RiverInflow; // mm * km²
-				}
+	for (int day = 0; day < ndays; day++){
 
-				//reserviors
-				if (G_RESAREA[cell] > 0) {
-					out_res = routingResHanasaki(day, cell, SimDate, PETWater, PrecWater, out_glolake,
-							Res_outflow, Res_overflow, S_ResStorage, Res_evapo, Res_inflow,
-							dailyUse, MeanDemand, K_release);
-				} else {
-					out_res = out_glolake;
-				}
+		if ((day % 100 == 0) && ctx.checkInterrupt) {
+			Rcpp::checkUserInterrupt(); // check for interrupt every 100 iterations
+		}
+
+		//calculate Net Abstraction in mm*km² / day for every cell for groundwater and surface water
+		// irrigation is considered as well as transfer of water for bigger cities (domestic)
+		int year = ctx.SimYear[day];
+		int month = ctx.SimMonth[day];
+		int dayDate = ctx.SimDay[day];
 
-				//out_res = out_glolake;
+		const vector<double>& MeanDemand = WaterUseMeanDemandDaily(ctx, year);
 
-				// global wetlands
-				if (G_GLOWET[cell] > 0) {
-					out_glowet =  routingGlobalWetlands(cell, PrecWater, PETWater, out_res,
-								 gloWetland_overflow, gloWetland_outflow, S_gloWetlandStorage,
-								 gloWetland_evapo, gloWetland_inflow);
-				} else {
-					out_glowet = out_res;
-				}
+		if (ctx.GapYearType == 1) { //avoid somulation of the 29.02 to compare modelling result to WG3
+			if ((dayDate == 29) && (month == 2)){
+				continue;
+			}
+		}
 
-				//river segment
-				riverVelocity = getRiverVelocity(flowVelocityType, cell, out_glowet); // 0 = const, other=variable [km/day]
-				RoutedOutflowCell = routingRiver(cell, riverVelocity, out_glowet,
-									QA_river, S_river); // mm*km²
+		ctx.dailyUse = ctx.waterUseSchedule.day(year, month); // first row = GW, second row = SW (see WaterUseInitSchedule())
 
-				//adding everything to next cell till outlet
-				downstreamcell = outflowOrder[cell]-1;
-				if (downstreamcell >= 0){
-					G_riverOutflow[downstreamcell] += RoutedOutflowCell;
-				}
+		ctx.G_actualUse.fill(0); //clean up actual use from Surface Water Bodies
+		ctx.G_riverOutflow.fill(0); //to clean up routing network befor starting simulation of actual day
 
-				//getting routed river in river network
-				RiverAvail(day, cell) = (RoutedOutflowCell / landSize); //mm;
-				if (outflowOrder[cell] < 0) { //end of basin is reached
-					Discharge[day] = RoutedOutflowCell / landSize; //mm
-					RiverVelocityStat[day] = riverVelocity / 86.4 ; // m/s
-				}
+		for (int n = 0; n < ctx.nRouteSteps; n++){ //routing steps from upstream to downstream (see initRoutingSchedule())
+#ifdef _OPENMP
+			#pragma omp parallel for schedule(static) num_threads(nThreads) if ((nThreads > 1) && (ctx.routeStepStart[n+1] - ctx.routeStepStart[n] >= ctx.minCellsParallel))
+#endif
+			for (int k = ctx.routeStepStart[n]; k < ctx.routeStepStart[n+1]; k++) {
+				const int cell = ctx.routeCells[k];
+				routingCell(ctx, out, day, cell, getUpstreamInflow(ctx, cell), Prec(day, cell), PETw(day, cell),
+							GroundwaterRunoff(day, cell) + surfaceRunoff(day, cell), MeanDemand, K_release, landSize);
 			} // cell loop
 			
 
 			//Abstracting Water Use for surface water
 			// river --> reservoir --> global lakes -->local lakes
 			if (dayDate==1 && month == 1) {
-				G_totalUnsatisfiedUse.fill(0); //for every year the unsatisfied demand is set to 0
+				ctx.G_totalUnsatisfiedUse.fill(0); //for every year the unsatisfied demand is set to 0
 			}
 		}
 
 		//subtract water use from cells for surface water bodies and note subtraction in vector
-		SubtractWaterConsumSW(WaterUseAllocationType, dailyUse, G_totalUnsatisfiedUse,
-						   S_river, S_ResStorage, S_gloLakeStorage,
-						   S_locLakeStorage,G_actualUse);
-		ActualUseSW(day,_) = G_actualUse;
-
-		//Save all states and fluxes to matrix
-		OverflowlocLake(day, _) = locLake_overflow; // mm*km² -> (GAREA * G_LOCLAK / 100.); //mm
-		OutflowlocLake(day, _) = locLake_outflow; // mm*km² - >(GAREA * G_LOCLAK / 100.); //mm
-		StoragelocLake(day, _) = S_locLakeStorage; // mm*km²- >(GAREA * G_LOCLAK / 100.); //mm
-		EvapolocLake(day, _) = locLake_evapo; // mm*km²- >(GAREA * G_LOCLAK / 100.); //mm
-		InflowlocLake(day, _) = locLake_inflow; // mm*km²- >(GAREA * G_LOCLAK / 100.); //mm
-
-		OverflowlocWetland(day, _) = locWetland_overflow; // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
-		OutflowlocWetland(day, _) = locWetland_outflow; // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
-		StoragelocWetland(day, _) = S_locWetlandStorage; // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
-		EvapolocWetland(day, _) = locWetland_evapo; // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
-		InflowlocWetland(day, _) = locWetland_inflow; // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
-
-		OverflowgloLake(day, _) = gloLake_overflow; // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
-		OutflowgloLake(day, _) = gloLake_outflow; // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
-		StoragegloLake(day, _) = S_gloLakeStorage; // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
-		EvapogloLake(day, _) = gloLake_evapo; // mm
-		InflowgloLake(day, _) = gloLake_inflow; // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
-
-		OutflowRes(day, _) = Res_outflow; // (GAREA * G_LOCWET / 100.); //mm
-		StorageRes(day, _) = S_ResStorage; // (GAREA * G_LOCWET / 100.); //mm
-		EvapoRes(day, _) = Res_evapo; // (GAREA * G_LOCWET / 100.); //mm
-		InflowRes(day, _) = Res_inflow; // (GAREA * G_LOCWET / 100.); //mm
-		OverflowRes(day, _) = Res_overflow; // (GAREA * G_LOCWET / 100.); //mm
-
-		OverflowgloWetland(day, _) = gloWetland_overflow; // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
-		OutflowgloWetland(day, _) = gloWetland_outflow; // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
-		StoragegloWetland(day, _) = S_gloWetlandStorage; // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
-		EvapogloWetland(day, _) = gloWetland_evapo; // mm
-		InflowgloWetland(day, _) = gloWetland_inflow; // mm*km²- >(GAREA * G_LOCWET / 100.); //mm
-
-		RiverStorage(day,_) = S_river;
+		SubtractWaterConsumSW(ctx, ctx.WaterUseAllocationType, ctx.dailyUse, ctx.G_totalUnsatisfiedUse,
+						   ctx.S_river, ctx.S_ResStorage, ctx.S_gloLakeStorage,
+						   ctx.S_locLakeStorage,ctx.G_actualUse);
+		saveRoutingDay(ctx, out, day);
 
 	}
+}
 
+// creates output list of the routing (uses R API -> only in main thread), frees the output buffers
+List getRoutingOutput(ModelContext& ctx, RoutingOutput& out){
+
+	// aggregated output: sums -> mean values of the output periods (matrices see outputToMatrix())
+	averageOutputPeriods(ctx, out.Discharge);
+	averageOutputPeriods(ctx, out.RiverVelocityStat);
+
+	NumericMatrix ActualUseSW = outputToMatrix(ctx, out.ActualUseSW);
 	List WaterUseSW = List::create(Named("ActualUseSW") = ActualUseSW);
-	List River = List::create(Named("Discharge") = Discharge, Named("RiverStorage")=RiverStorage, Named("InflowUpstream")=InflowUpstream2write, Named("RiverAvail") = RiverAvail, Named("RiverInNetwork")= S_river, Named("G_riverOutflow")= G_riverOutflow, Named("StatVelocity") = RiverVelocityStat);
-	List locLake = List::create(Named("Overflow") = OverflowlocLake, Named("Outflow") = OutflowlocLake, Named("Evapo") = EvapolocLake, Named("Storage") = StoragelocLake, Named("Inflow") = InflowlocLake);
-	List locWetland =List::create(Named("Overflow") = OverflowlocWetland, Named("Outflow") = OutflowlocWetland, Named("Evapo") = EvapolocWetland, Named("Storage") = StoragelocWetland, Named("Inflow") = InflowlocWetland);
-	List gloLake = List::create(Named("Overflow") = OverflowgloLake, Named("Outflow") = OutflowgloLake, Named("Evapo") = EvapogloLake, Named("Storage") = StoragegloLake, Named("Inflow") = InflowgloLake);
-	List Res =List::create(Named("Overflow") = OverflowRes, Named("Outflow") = OutflowRes, Named("Evapo") = EvapoRes, Named("Storage") = StorageRes, Named("Inflow") = InflowRes);
-	List gloWetland =List::create(Named("Overflow") = OverflowgloWetland, Named("Outflow") = OutflowgloWetland, Named("Evapo") = EvapogloWetland, Named("Storage") = StoragegloWetland, Named("Inflow") = InflowgloWetland);
+	List River = List::create(Named("Discharge") = out.Discharge, Named("RiverStorage")=outputToMatrix(ctx, out.RiverStorage), Named("InflowUpstream")=outputToMatrix(ctx, out.InflowUpstream2write), Named("RiverAvail") = outputToMatrix(ctx, out.RiverAvail), Named("RiverInNetwork")= ctx.S_river, Named("G_riverOutflow")= ctx.G_riverOutflow, Named("StatVelocity") = out.RiverVelocityStat);
+	List locLake = List::create(Named("Overflow") = outputToMatrix(ctx, out.OverflowlocLake), Named("Outflow") = outputToMatrix(ctx, out.OutflowlocLake), Named("Evapo") = outputToMatrix(ctx, out.EvapolocLake), Named("Storage") = outputToMatrix(ctx, out.StoragelocLake), Named("Inflow") = outputToMatrix(ctx, out.InflowlocLake));
+	List locWetland =List::create(Named("Overflow") = outputToMatrix(ctx, out.OverflowlocWetland), Named("Outflow") = outputToMatrix(ctx, out.OutflowlocWetland), Named("Evapo") = outputToMatrix(ctx, out.EvapolocWetland), Named("Storage") = outputToMatrix(ctx, out.StoragelocWetland), Named("Inflow") = outputToMatrix(ctx, out.InflowlocWetland));
+	List gloLake = List::create(Named("Overflow") = outputToMatrix(ctx, out.OverflowgloLake), Named("Outflow") = outputToMatrix(ctx, out.OutflowgloLake), Named("Evapo") = outputToMatrix(ctx, out.EvapogloLake), Named("Storage") = outputToMatrix(ctx, out.StoragegloLake), Named("Inflow") = outputToMatrix(ctx, out.InflowgloLake));
+	List Res =List::create(Named("Overflow") = outputToMatrix(ctx, out.OverflowRes), Named("Outflow") = outputToMatrix(ctx, out.OutflowRes), Named("Evapo") = outputToMatrix(ctx, out.EvapoRes), Named("Storage") = outputToMatrix(ctx, out.StorageRes), Named("Inflow") = outputToMatrix(ctx, out.InflowRes));
+	List gloWetland =List::create(Named("Overflow") = outputToMatrix(ctx, out.OverflowgloWetland), Named("Outflow") = outputToMatrix(ctx, out.OutflowgloWetland), Named("Evapo") = outputToMatrix(ctx, out.EvapogloWetland), Named("Storage") = outputToMatrix(ctx, out.StoragegloWetland), Named("Inflow") = outputToMatrix(ctx, out.InflowgloWetland));
 
 
 	List L = List::create(Named("WaterUseSW") = ActualUseSW, Named("River") = River,
@@ -320,21 +489,18 @@ List routing(DateVector SimPeriod, NumericMatrix surfaceRunoff, NumericMatrix Gr
 	return(L);
 }
 
-//' @title CheckResType
-//' @description function to simulate reservoirs as global lakes, when res_type is zero, so unknown
-//' @export
-// [[Rcpp::export]]
-void CheckResType(){
-	if (ReservoirType == 1){
-		for (int cell = 0; cell < array_size; cell++) {
-			G_LAKAREA[cell] += G_RESAREA[cell]; //use reservoir area as lake area, or sum up reservoir and lake area
-			G_RESAREA[cell] = 0; //set reservoir area to zero
+// reservoirs are simulated as global lakes, when res_type is zero, so unknown (or with ReservoirType 1)
+void CheckResType(ModelContext& ctx){
+	if (ctx.ReservoirType == 1){
+		for (int cell = 0; cell < ctx.array_size; cell++) {
+			ctx.par.wb.G_LAKAREA[cell] += ctx.par.wb.G_RESAREA[cell]; //use reservoir area as lake area, or sum up reservoir and lake area
+			ctx.par.wb.G_RESAREA[cell] = 0; //set reservoir area to zero
 		}
 	} else {
-		for (int cell = 0; cell < array_size; cell++) {
-			if (G_RES_TYPE[cell] == 0) {// IF reservoir type is UNKNOWN
-				G_LAKAREA[cell] += G_RESAREA[cell]; //use reservoir area as lake area, or sum up reservoir and lake area
-				G_RESAREA[cell] = 0; //set reservoir area to zero
+		for (int cell = 0; cell < ctx.array_size; cell++) {
+			if (ctx.par.wb.G_RES_TYPE[cell] == 0) {// IF reservoir type is UNKNOWN
+				ctx.par.wb.G_LAKAREA[cell] += ctx.par.wb.G_RESAREA[cell]; //use reservoir area as lake area, or sum up reservoir and lake area
+				ctx.par.wb.G_RESAREA[cell] = 0; //set reservoir area to zero
 				// have to think about option to write out the affected cells
 			}
 		}
@@ -343,30 +509,23 @@ void CheckResType(){
 
 
 
-//' @title setLakeWetlandToMaximum
-//' @description function that sets storage of all surface water bodies to max; is implemented in original model version (actually because of this, warm-up-period should be quite long > 2a)
-//' @param S_locLakeStorage local lake storage
-//' @param S_locWetlandStorage local wetland storage
-//' @param S_gloLakeStorage global lake storage
-//' @param S_ResStorage reservoir storage
-//' @param S_gloWetlandStorage global wetland storage
-//' @export
-// [[Rcpp::export]]
-void setLakeWetlandToMaximum(NumericVector S_locLakeStorage, NumericVector S_locWetlandStorage,
-							NumericVector S_gloLakeStorage, NumericVector S_ResStorage,
-							NumericVector S_gloWetlandStorage) {
+// sets storage of all surface water bodies (local/global lakes and wetlands, reservoirs) to max; is implemented in original model version
+// (actually because of this, warm-up-period should be quite long > 2a)
+void setLakeWetlandToMaximum(ModelContext& ctx, NumericVector& S_locLakeStorage, NumericVector& S_locWetlandStorage,
+							NumericVector& S_gloLakeStorage, NumericVector& S_ResStorage,
+							NumericVector& S_gloWetlandStorage) {
 
-	for (int cell = 0; cell < array_size; cell++) {
+	for (int cell = 0; cell < ctx.array_size; cell++) {
 
-		S_locLakeStorage[cell] = (G_LOCLAK[cell] / 100.0) * GAREA[cell] * lakeDepth * 1000 * 1000; //[mm km²]
+		S_locLakeStorage[cell] = (ctx.par.wb.G_LOCLAK[cell] / 100.0) * ctx.par.wb.GAREA[cell] * ctx.lakeDepth * 1000 * 1000; //[mm km²]
 
-		S_locWetlandStorage[cell] = (G_LOCWET[cell] / 100.0) * GAREA[cell] * wetlandDepth * 1000 * 1000; //[mm km²]
+		S_locWetlandStorage[cell] = (ctx.par.wb.G_LOCWET[cell] / 100.0) * ctx.par.wb.GAREA[cell] * ctx.wetlandDepth * 1000 * 1000; //[mm km²]
 
-		S_gloLakeStorage[cell] = G_LAKAREA[cell] * lakeDepth * 1000 * 1000; //[mm km²]
+		S_gloLakeStorage[cell] = ctx.par.wb.G_LAKAREA[cell] * ctx.lakeDepth * 1000 * 1000; //[mm km²]
 
-		S_gloWetlandStorage[cell] = (G_GLOWET[cell] / 100.0) * GAREA[cell] * wetlandDepth * 1000 * 1000; //[mm km²]
+		S_gloWetlandStorage[cell] = (ctx.par.wb.G_GLOWET[cell] / 100.0) * ctx.par.wb.GAREA[cell] * ctx.wetlandDepth * 1000 * 1000; //[mm km²]
 
-		S_ResStorage[cell] = G_STORAGE_CAPACITY[cell] * 0.85 * 1000 * 1000;	//[mm km²]
+		S_ResStorage[cell] = ctx.par.wb.G_STORAGE_CAPACITY[cell] * 0.85 * 1000 * 1000;	//[mm km²]
 	}
 }
 
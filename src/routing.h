@@ -1,4 +1,7 @@
 #include <Rcpp.h>
+#include "ModelContext.h"
+#include "ModelTools.h"
+#include "OutputMatrix.h"
 
 using namespace std;
 using namespace Rcpp;
@@ -6,7 +9,75 @@ using namespace Rcpp;
 #ifndef ROUTING_H
 #define ROUTING_H
 
-List routing(DateVector SimPeriod, NumericMatrix surfaceRunoff, NumericMatrix GroundwaterRunoff, 
+// output of the routing (see OutputMatrix)
+// it is allocated before the simulation starts, so that simulateRouting() does not need the R API (see runModelBatch())
+struct RoutingOutput {
+	NumericVector Discharge;
+	NumericVector RiverVelocityStat;
+
+	//Zustände die gespeichert werden
+	OutputMatrix RiverAvail; //
+	OutputMatrix InflowUpstream2write; //
+
+
+	//local Lakes
+	OutputMatrix OverflowlocLake; // special overflow, when S > Smax
+	OutputMatrix OutflowlocLake;  // total outflow
+	OutputMatrix StoragelocLake;  // storage of lake
+	OutputMatrix EvapolocLake;    // Evaporatiom from Lake
+	OutputMatrix InflowlocLake;   // Inflow to Lake
+
+	//local wetlands
+	OutputMatrix OverflowlocWetland; // special overflow, when S > Smax
+	OutputMatrix OutflowlocWetland;  // total outflow
+	OutputMatrix StoragelocWetland;  // storage of Wetland
+	OutputMatrix EvapolocWetland;    // Evaporatiom from Wetland
+	OutputMatrix InflowlocWetland;   // Inflow to Wetland
+
+	//global Lakes
+	OutputMatrix OverflowgloLake; // special overflow, when S > Smax
+	OutputMatrix OutflowgloLake;  // total outflow
+	OutputMatrix StoragegloLake;  // storage of lake
+	OutputMatrix EvapogloLake;    // Evaporatiom from Lake
+	OutputMatrix InflowgloLake;   // Inflow to Lake
+
+	//reservoirs
+	OutputMatrix OutflowRes;  // total outflow
+	OutputMatrix StorageRes;  // storage of Reservoir
+	OutputMatrix EvapoRes;    // Evaporatiom from Reservoir
+	OutputMatrix InflowRes;   // Inflow to Reservoir  Res_overflow
+	OutputMatrix OverflowRes; // overflow from Reservoir when precipitation above Reservoir and Inflow are to high
+
+	//global wetlands
+	OutputMatrix OverflowgloWetland; // special overflow, when S > Smax
+	OutputMatrix OutflowgloWetland;  // total outflow
+	OutputMatrix StoragegloWetland;  // storage of Wetland
+	OutputMatrix EvapogloWetland;    // Evaporatiom from Wetland
+	OutputMatrix InflowgloWetland;   // Inflow to Wetland
+
+	//River
+	OutputMatrix RiverStorage; // special overflow, when S > Smax
+
+	//WaterUse
+	OutputMatrix ActualUseSW;
+};
+
+List routing(ModelContext& ctx, DateVector SimPeriod, NumericMatrix surfaceRunoff, NumericMatrix GroundwaterRunoff, 
 			NumericMatrix PETw, NumericMatrix Prec);
+
+vector< pair<string, OutputMatrix*> > getRoutingOutputTable(RoutingOutput& out);
+void initRoutingOutput(ModelContext& ctx, RoutingOutput& out, const OutputSpec& spec = OutputSpec());
+void simulateRouting(ModelContext& ctx, RoutingOutput& out, const OutputMatrix& surfaceRunoff, const OutputMatrix& GroundwaterRunoff,
+			const OutputMatrix& PETw, const ForcingMatrix& Prec);
+List getRoutingOutput(ModelContext& ctx, RoutingOutput& out);
+
+// parts of simulateRouting() that are also used by the coupled simulation (see runModelCoupled())
+void CheckResType(ModelContext& ctx);
+double getLandSize(ModelContext& ctx);
+vector<double> initReleaseFactor(ModelContext& ctx);
+double routingCell(ModelContext& ctx, RoutingOutput& out, int day, int cell, double UpstreamOutflow,
+			double PrecWater, double PETWater, double LandRunoff,
+			const vector<double>& MeanDemand, vector<double>& K_release, double landSize);
+void saveRoutingDay(ModelContext& ctx, RoutingOutput& out, int day);
 			
 #endif
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 //' @title routingGlobalLakes
 //' @description function that defines roouting through global lakes
+//' @param ctx ModelContext of the model
 //' @param cell cell that is simulated
 //' @param PrecWater Pecipitation above cell [mm]
 //' @param PETWater Potential Evaporation form water [mm]
@@ -16,9 +17,9 @@
 //' @param gloLake_inflow inflow to global lake: inflow + PrecWater * G_LAKAREA[cell] [mm*km²]
 //' @return total outflow form global lake: outflow + overflow [mm*km²]
 //' @export
-double routingGlobalLakes(int cell, double PrecWater, double PETWater, double inflow,
-			NumericVector gloLake_overflow, NumericVector gloLake_outflow , NumericVector S_gloLakeStorage, 
-			NumericVector gloLake_evapo, NumericVector gloLake_inflow) {
+double routingGlobalLakes(ModelContext& ctx, int cell, double PrecWater, double PETWater, double inflow,
+			NumericVector& gloLake_overflow, NumericVector& gloLake_outflow , NumericVector& S_gloLakeStorage, 
+			NumericVector& gloLake_evapo, NumericVector& gloLake_inflow) {
 	
 	double maxStorage;
 	double totalInflow;
@@ -38,8 +39,8 @@ double routingGlobalLakes(int cell, double PrecWater, double PETWater, double in
 	// (which might even be much greater than one cell)
 
 	
-	maxStorage = G_LAKAREA[cell] * (lakeDepth * 1000 * 1000); //// maximum storage capacity [mm km²]
-	totalInflow = inflow + PrecWater * G_LAKAREA[cell]; //// calculate inflow only [mm km²]
+	maxStorage = ctx.par.wb.G_LAKAREA[cell] * (ctx.lakeDepth * 1000 * 1000); //// maximum storage capacity [mm km²]
+	totalInflow = inflow + PrecWater * ctx.par.wb.G_LAKAREA[cell]; //// calculate inflow only [mm km²]
 
 
 	// This factor was added to reduce PET as a function of actual lake storage (2.1f).
@@ -48,10 +49,10 @@ double routingGlobalLakes(int cell, double PrecWater, double PETWater, double in
 		gloLakeEvapoReductionFactor = 1.;
 	} else {
 		gloLakeEvapoReductionFactor = 1. - pow(fabs(S_gloLakeStorage[cell] - maxStorage)
-								/ maxStorage, evapoReductionExp);
+								/ maxStorage, ctx.evapoReductionExp);
 	}
 	
-	evaporation = (PETWater * gloLakeEvapoReductionFactor) * G_LAKAREA[cell]; // calculate evaporation from global lakes [mm km²]
+	evaporation = (PETWater * gloLakeEvapoReductionFactor) * ctx.par.wb.G_LAKAREA[cell]; // calculate evaporation from global lakes [mm km²]
 	S_gloLakeStorage[cell] -= evaporation; //substract global lake evapo [mm km²]
 
 	// if G_gloLakeStorage is below '0' storage and surfStorageEvapo has to be adjusted
@@ -64,8 +65,8 @@ double routingGlobalLakes(int cell, double PrecWater, double PETWater, double in
 	storagePrevRouting = S_gloLakeStorage[cell];
 	
 	// calculate routing through G_gloLakeStorage
-	S_gloLakeStorage[cell] = ( storagePrevRouting * exp(-1./glo_storageFactor))
-				+ (totalInflow * glo_storageFactor * (1. - exp(-1./glo_storageFactor)));
+	S_gloLakeStorage[cell] = ( storagePrevRouting * exp(-1./ctx.glo_storageFactor))
+				+ (totalInflow * ctx.glo_storageFactor * (1. - exp(-1./ctx.glo_storageFactor)));
 				
 	//G_gloLakeStorage[n] = ( G_gloLakeStoragePrevStep * exp(-1./(((double) timeStepsPerDay) * 1./glo_storageFactor)) )
 	//		+ (totalInflow * ((double) timeStepsPerDay) * 1./glo_storageFactor * (1. - exp(-1./(((double) timeStepsPerDay) * 1./glo_storageFactor))) );
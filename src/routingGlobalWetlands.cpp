@@ -8,6 +8,7 @@ using namespace std;
 
 //' @title routingGlobalWetlands
 //' @description function that defines roouting through global wetlands
+//' @param ctx ModelContext of the model
 //' @param cell cell that is simulated
 //' @param PrecWater Pecipitation above cell [mm]
 //' @param PETWater Potential Evaporation form water [mm]
@@ -19,9 +20,9 @@ using namespace std;
 //' @param gloWetland_inflow inflow to global wetland: inflow + (PrecWater * GAREA[cell] * G_GLOWET[cell]/100) [mm*km²]
 //' @return total outflow form global wetland: outflow + overflow [mm*km²]
 //' @export
-double routingGlobalWetlands(int cell, double PrecWater, double PETWater, double inflow,
-		NumericVector gloWetland_overflow, NumericVector gloWetland_outflow, NumericVector S_gloWetlandStorage, 
-		NumericVector gloWetland_evapo, NumericVector gloWetland_inflow){
+double routingGlobalWetlands(ModelContext& ctx, int cell, double PrecWater, double PETWater, double inflow,
+		NumericVector& gloWetland_overflow, NumericVector& gloWetland_outflow, NumericVector& S_gloWetlandStorage, 
+		NumericVector& gloWetland_evapo, NumericVector& gloWetland_inflow){
 	
 	double maxStorage;
 	double totalInflow;
@@ -32,17 +33,17 @@ double routingGlobalWetlands(int cell, double PrecWater, double PETWater, double
 	
 	double gloWetlEvapoReductionFactor; // open water PET reduction (2.1f)
 
-	maxStorage = (G_GLOWET[cell] / 100.) * GAREA[cell] * (wetlandDepth * 1000 * 1000); // maximum storage capacity [mm km²]
-	totalInflow = inflow + (PrecWater * GAREA[cell] * G_GLOWET[cell]/100); // calculate inflow only [mm km²]
+	maxStorage = (ctx.par.wb.G_GLOWET[cell] / 100.) * ctx.par.wb.GAREA[cell] * (ctx.wetlandDepth * 1000 * 1000); // maximum storage capacity [mm km²]
+	totalInflow = inflow + (PrecWater * ctx.par.wb.GAREA[cell] * ctx.par.wb.G_GLOWET[cell]/100); // calculate inflow only [mm km²]
 
 	// This factor was added to reduce PET as a function of actual wetland storage (2.1f).
 	if (S_gloWetlandStorage[cell] > maxStorage)
 		gloWetlEvapoReductionFactor = 1.;
 	else
 		gloWetlEvapoReductionFactor = 1. - pow(fabs(S_gloWetlandStorage[cell] - maxStorage)
-								/ maxStorage, evapoReductionExp);
+								/ maxStorage, ctx.evapoReductionExp);
 
-	evaporation = PETWater * gloWetlEvapoReductionFactor * GAREA[cell] * (G_GLOWET[cell]/100.); // calculate evaporation from global wetlands [mm*km²]
+	evaporation = PETWater * gloWetlEvapoReductionFactor * ctx.par.wb.GAREA[cell] * (ctx.par.wb.G_GLOWET[cell]/100.); // calculate evaporation from global wetlands [mm*km²]
 	S_gloWetlandStorage[cell] -= evaporation;// substract global wetland evapo [mm km²]
 						 
 	// if G_gloWetlStorage is below '0' storage and surfStorageEvapo has to be adjusted
@@ -54,8 +55,8 @@ double routingGlobalWetlands(int cell, double PrecWater, double PETWater, double
 	storagePrevRouting = S_gloWetlandStorage[cell];
 
 	// calculate routing through G_gloWetlStorage
-	S_gloWetlandStorage[cell] = ( storagePrevRouting * exp(-1./glo_storageFactor) )
-				+ (totalInflow * glo_storageFactor * (1. - exp(-1./glo_storageFactor)) );
+	S_gloWetlandStorage[cell] = ( storagePrevRouting * exp(-1./ctx.glo_storageFactor) )
+				+ (totalInflow * ctx.glo_storageFactor * (1. - exp(-1./ctx.glo_storageFactor)) );
 
 	outflow = totalInflow + storagePrevRouting - S_gloWetlandStorage[cell];
 
@@ -1,8 +1,10 @@
 #ifndef ROUTINGLOCALWATERBODIES_H
 #define ROUTINGLOCALWATERBODIES_H
 
-double routingLocalWaterBodies(bool Type, int cell, double PrecWater,  double PETWater, double Inflow,
-								NumericVector S_locLakeStorage, NumericVector locLake_overflow, NumericVector locLake_outflow, NumericVector locLake_evapo, NumericVector locLake_inflow,
-								NumericVector S_locWetlandStorage, NumericVector locWetland_overflow, NumericVector locWetland_outflow, NumericVector locWetland_evapo, NumericVector locWetland_inflow);
-								
-								#endif
\ No newline at end of file
+// type of local waterbody (template parameter of routingLocalWaterBodies())
+enum LocalWaterBodyType { LOCAL_LAKE = 0, LOCAL_WETLAND = 1 };
+
+template <int Type>
+double routingLocalWaterBodies(ModelContext& ctx, int cell, double PrecWater,  double PETWater, double Inflow);
+
+#endif
@@ -11,9 +11,9 @@ using namespace std;
 
 //' @title routingResHanasaki
 //' @description function that defines routing through reservoir (after Hanasaki)
+//' @param ctx ModelContext of the model
 //' @param day of simulation period (0 = 1st day of simulation period)
 //' @param cell cell that is simulated
-//' @param SimDate Date of day which is simulated
 //' @param PETWater Potential Evaporation from water [mm]
 //' @param PrecWater Pecipitation above cell [mm]
 //' @param inflow inflow to reservoir from network [mm*km²]
@@ -22,17 +22,18 @@ using namespace std;
 //' @param S_ResStorage storage of reservoir [mm*km²]
 //' @param Res_evapo evaporation from reservoir: evaporation = (PETWater * gloResEvapoReductionFactor)* G_RESAREA[cell] [mm*km²]
 //' @param Res_inflow inflow to reservoir: inflow + ( PrecWater * G_RESAREA[cell]);//[mm km²]
-//' @param dailyUse information of water that needs to be abstracted from surface water (second row of NumericMatrix)
+//' @param dailyUse information of water that needs to be abstracted from surface water (second row of WaterUseDay)
 //' @param MeanDemand output of WaterUseCalcMeanDemandDaily(year, GapYearType)
+//' @param K_release release factor of reservoirs (updated at the beginning of the operational year)
 //' @return total outflow form reservoir: outflow + overflow [mm*km²]
 //' @export
-double routingResHanasaki(int day, int cell, Date SimDate, double PETWater, double PrecWater, double inflow, 
-							NumericVector Res_outflow, NumericVector Res_overflow, NumericVector S_ResStorage, NumericVector Res_evapo, NumericVector Res_inflow,
-							NumericMatrix dailyUse, NumericVector MeanDemand, NumericVector K_release) {
+double routingResHanasaki(ModelContext& ctx, int day, int cell, double PETWater, double PrecWater, double inflow, 
+							NumericVector& Res_outflow, NumericVector& Res_overflow, NumericVector& S_ResStorage, NumericVector& Res_evapo, NumericVector& Res_inflow,
+							const WaterUseDay& dailyUse, const vector<double>& MeanDemand, vector<double>& K_release) {
 
-	int dayDate = SimDate.getDay(); //day that is simulated
-	int monthDate = SimDate.getMonth(); // month that is simulated
-	int yearDate = SimDate.getYear(); // year that is simulated
+	int dayDate = ctx.SimDay[day]; //day that is simulated
+	int monthDate = ctx.SimMonth[day]; // month that is simulated
+	int yearDate = ctx.SimYear[day]; // year that is simulated
 	int daysInMonth = numberOfDaysInMonth(monthDate, yearDate);
 	
 	double maxStorage; 
@@ -48,18 +49,18 @@ double routingResHanasaki(int day, int cell, Date SimDate, double PETWater, doub
 	double dailyUseCell;
 	
 	// G_MEAN_INFLOW in km³/month --> mm*km²/day --> *1000 * 1000 / daysInMonth()
-	double meanInflow = G_MEAN_INFLOW[cell]*1000*1000/daysInMonth; //[mm*km²/day]
+	double meanInflow = ctx.par.wb.G_MEAN_INFLOW[cell]*1000*1000/daysInMonth; //[mm*km²/day]
 	
 
 	// define storage capacity to mean annual inflow ratio (c_ratio)
 	// G_mean_inflow:  km³/month,  G_stor_cap:  km3/yr
-	c_ratio = G_STORAGE_CAPACITY[cell]/(G_MEAN_INFLOW[cell]*12);
-	maxStorage = G_STORAGE_CAPACITY[cell] * 0.85 * 1000 *1000; //85 % of storage capacity (from published volume data) [mm km²]
+	c_ratio = ctx.par.wb.G_STORAGE_CAPACITY[cell]/(ctx.par.wb.G_MEAN_INFLOW[cell]*12);
+	maxStorage = ctx.par.wb.G_STORAGE_CAPACITY[cell] * 0.85 * 1000 *1000; //85 % of storage capacity (from published volume data) [mm km²]
 	
 	// ######### CALCULATING WATERBALANCE ANALOG TO ALL WATERBODIES ###############
 	
 	//inflow from upstream PLUS lake water balance
-	totalInflow = inflow + ( PrecWater * G_RESAREA[cell]);//[mm km²]
+	totalInflow = inflow + ( PrecWater * ctx.par.wb.G_RESAREA[cell]);//[mm km²]
 				
 	// add inflow to storage
 	S_ResStorage[cell] += totalInflow;
@@ -69,10 +70,10 @@ double routingResHanasaki(int day, int cell, Date SimDate, double PETWater, doub
 		gloResEvapoReductionFactor = 1.;
 	else
 		gloResEvapoReductionFactor = 1. - pow(fabs(S_ResStorage[cell] - maxStorage)
-							/ maxStorage, evapoReductionExpReservoir);
+							/ maxStorage, ctx.evapoReductionExpReservoir);
 
 	// calculate evaporation from global lakes
-	evaporation = (PETWater * gloResEvapoReductionFactor)* G_RESAREA[cell]; // [mm km²]
+	evaporation = (PETWater * gloResEvapoReductionFactor)* ctx.par.wb.G_RESAREA[cell]; // [mm km²]
 
 	// substract global lake evapo
 	S_ResStorage[cell] -= evaporation; //[mm km²]
@@ -86,16 +87,16 @@ double routingResHanasaki(int day, int cell, Date SimDate, double PETWater, doub
 	// ######### APPLYING RESERVOIR ALGORITHM AFTER HANASAKI ###############
 	
 	//set rules at the beginning of the operational year! (only once per operational year!)
-	if ((dayDate == 1) & (monthDate == G_START_MONTH[cell])){
+	if ((dayDate == 1) & (monthDate == ctx.par.wb.G_START_MONTH[cell])){
 		//calculate release coefficient for the actual year:
 		//reduce release coefficent in this year to refill storage volume in reservoir
 		double MIN_RELEASE = 0.1;
 		double KM3_to_MMKM2 = 1000. * 1000.;
-		K_release[cell] = max(S_ResStorage[cell] / (G_STORAGE_CAPACITY[cell] * KM3_to_MMKM2 ), MIN_RELEASE );
+		K_release[cell] = max(S_ResStorage[cell] / (ctx.par.wb.G_STORAGE_CAPACITY[cell] * KM3_to_MMKM2 ), MIN_RELEASE );
 	}
 	
 	// algorithm based on water use
-	if (G_RES_TYPE[cell] == 1) {// (irrigation reservoir)
+	if (ctx.par.wb.G_RES_TYPE[cell] == 1) {// (irrigation reservoir)
 
 		//calculate monthly demand of downstream area
 		dailyUseCell = dailyUse(1,cell); //Surface Water Net abstraction for cell in mm*km²/day
@@ -104,13 +105,10 @@ double routingResHanasaki(int day, int cell, Date SimDate, double PETWater, doub
 		// approach to estimate water demand that can be satisfied by reservoir
 		// limits are: 1) 20 routing steps 2) no more donwstream cell (ocean/basin border) 3) another reservoir
 		// at the moment basin outlet is defined with -999 in outflow, needs to be changed when simulating more than one basin!
-		int i=0; 
-		int downstreamCell=outflowOrder[cell];
-		while (i < reservoir_dsc && downstreamCell > 0 && downstreamCell < array_size && G_RESAREA[downstreamCell-1] == 0) {
+		// (downstream cells are precalculated in initDownstreamPaths())
+		for (int k = ctx.downstreamStart[cell]; k < ctx.downstreamReservoirEnd[cell]; k++) {
 			//suggestion Jenny: only consider positive values here
-			dailyUseCell += dailyUse(1,downstreamCell-1) * G_ALLOC_COEFF(i++, cell);
-			// next downstream cell
-			downstreamCell = outflowOrder[downstreamCell-1];
+			dailyUseCell += dailyUse(1,ctx.downstreamCells[k]) * ctx.downstreamCoeff[k];
 		}
 
 				
@@ -123,7 +121,7 @@ double routingResHanasaki(int day, int cell, Date SimDate, double PETWater, doub
 			//provisional monthly release = i_mean + monthly_demand_sum - d_mean)
 			prov_rel = meanInflow + dailyUseCell - MeanDemand[cell]; // [mm*km²/day]
 		}
-	} else if ((G_RES_TYPE[cell] >= 2) ) {//(non-irrigation: domestic & hydropower)  //$$$Christof: resOpt ==1 (Hanasaki)
+	} else if ((ctx.par.wb.G_RES_TYPE[cell] >= 2) ) {//(non-irrigation: domestic & hydropower)  //$$$Christof: resOpt ==1 (Hanasaki)
 		prov_rel = meanInflow; // [mm*km²/day]
 	} else {
 	  prov_rel = 0.;
@@ -139,7 +137,7 @@ double routingResHanasaki(int day, int cell, Date SimDate, double PETWater, doub
 
 	//new outflow
 	//reservoir storage volume should not be less than 10% of maximum!)...
-	if (S_ResStorage[cell] >= (G_STORAGE_CAPACITY[cell]*1000*1000 * 0.1)) {
+	if (S_ResStorage[cell] >= (ctx.par.wb.G_STORAGE_CAPACITY[cell]*1000*1000 * 0.1)) {
 		outflow = release;  //m3/s  ->  km3/routing time step
 	} else { //...otherwise outflow will be reduced! (outflow should not be stopped, because we should serve ecosystem demands)
 		outflow = 0.1 * release;
@@ -2,14 +2,16 @@
 #define ROUTINGRESHANASAKI_H
 
 #include <Rcpp.h>
+#include <vector>
+#include "ModelContext.h"
 
 using namespace std;
 using namespace Rcpp;
 
 
-double routingResHanasaki(int day, int cell, Date SimDate, double PETWater, double PrecWater, double inflow, 
-							NumericVector Res_outflow, NumericVector Res_overflow, NumericVector S_ResStorage, NumericVector Res_evapo, NumericVector Res_inflow,
-							NumericMatrix dailyUse, NumericVector MeanDemand, NumericVector K_release);
+double routingResHanasaki(ModelContext& ctx, int day, int cell, double PETWater, double PrecWater, double inflow, 
+							NumericVector& Res_outflow, NumericVector& Res_overflow, NumericVector& S_ResStorage, NumericVector& Res_evapo, NumericVector& Res_inflow,
+							const WaterUseDay& dailyUse, const vector<double>& MeanDemand, vector<double>& K_release);
 							
 int numberOfDaysInMonth(int month, int year);
 int numberOfDaysInYear(int year);
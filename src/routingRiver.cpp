@@ -8,22 +8,21 @@ using namespace std;
 
 //' @title routingRiver
 //' @description function that defines routing through river - note: uses original model code with bug in ELS equation
+//' @param ctx ModelContext of the model
 //' @param cell cell that is simulated
 //' @param riverVelocity river velocity in km/d
 //' @param RiverInflow inflow to river network [mm*km²/d]
 //' @param G_riverOutflow transportedVolume in [mm*km²/d]
 //' @param S_river river storage [mm*km²]
 //' @return transportedVolume in [mm*km²/d]
-//' @export
-// [[Rcpp::export]]
-double routingRiver(int cell, double riverVelocity, double RiverInflow,
-					NumericVector G_riverOutflow, NumericVector S_river) {
+double routingRiver(ModelContext& ctx, int cell, double riverVelocity, double RiverInflow,
+					NumericVector& G_riverOutflow, NumericVector& S_river) {
 
 	double K;
 	double G_riverStoragePrevStep;
 	double transportedVolume;
 
-	K = G_riverLength[cell] / riverVelocity; // [km / (km/d)] = [d]
+	K = ctx.par.river.G_riverLength[cell] / riverVelocity; // [km / (km/d)] = [d]
 	G_riverStoragePrevStep = S_river[cell]; //[mm * km²]
 
 	S_river[cell] = ( G_riverStoragePrevStep * exp(-1./ K) )
@@ -38,17 +37,16 @@ double routingRiver(int cell, double riverVelocity, double RiverInflow,
 
 //' @title getRiverVelocity
 //' @description function that defines river velocity for routing (variable or constant)
+//' @param ctx ModelContext of the model
 //' @param Type 0 (constant) or 1 (variable)
 //' @param cell cell that is simulated
 //' @param inflow inflow to river in mm*km²/day
 //' @return riverVelocity in km/day
-//' @export
-// [[Rcpp::export]]
-double getRiverVelocity(int Type, int cell, double inflow){
+double getRiverVelocity(ModelContext& ctx, int Type, int cell, double inflow){
 
 	double riverVelocity = 0;
 	if (Type==0) {
-		riverVelocity = defaultRiverVelocity;
+		riverVelocity = ctx.defaultRiverVelocity;
 	} else {
 		//uses: bankfull flow, river width, river slope
 		double riverDepth;
@@ -66,19 +64,19 @@ double getRiverVelocity(int Type, int cell, double inflow){
 
 
 		// to avoid negative bottom width
-		if (G_BANKFULL[cell] < 0.05) {G_BANKFULL[cell] = 0.05; } //not sure why this is set...
+		if (ctx.par.river.G_BANKFULL[cell] < 0.05) {ctx.par.river.G_BANKFULL[cell] = 0.05; } //not sure why this is set...
 
 		// SE: quick fix to prevent further increase of river velocity at overbank discharges
 		// JK: actually it should sink again when exceeding bankfull flow..
-		if (incoming_discharge > G_BANKFULL[cell] )
-			incoming_discharge = G_BANKFULL[cell];
+		if (incoming_discharge > ctx.par.river.G_BANKFULL[cell] )
+			incoming_discharge = ctx.par.river.G_BANKFULL[cell];
 
 		// calculate river depth
 		riverDepth = 0.349 * pow(incoming_discharge, 0.341); //[m]
 
 		// calculate river bottom width asssuming a trapezoidal channes with 2/1 run to rise ratio
-		G_RiverWidth_bf = 2.71 * pow(G_BANKFULL[cell], 0.557); //[m]
-		G_RiverDepth_bf = 0.349 * pow(G_BANKFULL[cell], 0.341); //[m]
+		G_RiverWidth_bf = 2.71 * pow(ctx.par.river.G_BANKFULL[cell], 0.557); //[m]
+		G_RiverDepth_bf = 0.349 * pow(ctx.par.river.G_BANKFULL[cell], 0.341); //[m]
 		G_riverBottomWidth = G_RiverWidth_bf - 2.0 * 2.0 * G_RiverDepth_bf;
 
 		// trapezoidal channel shape with channel sides 2:1 run to rise ratio
@@ -88,7 +86,7 @@ double getRiverVelocity(int Type, int cell, double inflow){
 
 
 		// calculate riverVelocity
-		riverVelocity = 1./G_riverRoughness[cell] * pow(hydraulicRad, (2./3.)) * pow(G_riverSlope[cell], 0.5); //[m/sec]
+		riverVelocity = 1./ctx.par.river.G_riverRoughness[cell] * pow(hydraulicRad, (2./3.)) * pow(ctx.par.river.G_riverSlope[cell], 0.5); //[m/sec]
 		riverVelocity = riverVelocity * 86.4; //m/sec -->km/day (60*60*24)/1000
 
 		// return value in [km/day]; if value is below 1cm/day then set limit
@@ -100,3 +98,19 @@ double getRiverVelocity(int Type, int cell, double inflow){
 	return(riverVelocity);
 }
 
+//' @title getUpstreamInflow
+//' @description function that sums up the outflow of all upstream cells in the actual day (see initRoutingSchedule()); inflow is pulled by every cell
+//' instead of adding the outflow to the downstream cell, so all cells of one routing step can be simulated in parallel
+//' @param ctx ModelContext of the model
+//' @param cell cell that is simulated
+//' @return inflow from upstream cells in [mm*km²/d] (also saved in G_riverOutflow)
+double getUpstreamInflow(ModelContext& ctx, int cell){
+
+	double inflow = 0.;
+	for (int k = ctx.upstreamStart[cell]; k < ctx.upstreamStart[cell + 1]; k++){
+		inflow += ctx.QA_river[ctx.upstreamCells[k]]; // outflow of upstream cell (routingRiver())
+	}
+	ctx.G_riverOutflow[cell] = inflow;
+
+	return(inflow);
+}
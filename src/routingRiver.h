@@ -1,13 +1,15 @@
 #ifndef ROUTINGRIVER_H
 #define ROUTINGRIVER_H
 
-double routingRiver(int cell, double riverVelocity, double RiverInflow,
-					NumericVector G_riverOutflow, NumericVector S_river);
+double routingRiver(ModelContext& ctx, int cell, double riverVelocity, double RiverInflow,
+					NumericVector& G_riverOutflow, NumericVector& S_river);
 					
-double getRiverVelocity(int Type, int cell, double inflow);
+double getRiverVelocity(ModelContext& ctx, int Type, int cell, double inflow);
 
-void setLakeWetlandToMaximum(NumericVector S_locLakeStorage, NumericVector S_locWetlandStorage, 
-							NumericVector S_gloLakeStorage, NumericVector S_ResStorage, 
-							NumericVector S_gloWetlandStorage); 
+double getUpstreamInflow(ModelContext& ctx, int cell);
+
+void setLakeWetlandToMaximum(ModelContext& ctx, NumericVector& S_locLakeStorage, NumericVector& S_locWetlandStorage, 
+							NumericVector& S_gloLakeStorage, NumericVector& S_ResStorage, 
+							NumericVector& S_gloWetlandStorage); 
 #endif
 
@@ -5,6 +5,7 @@
 #include "daily.h"
 #include "routing.h"
 #include "runWarmUp.h"
+#include "runModel.h"
 
 using namespace std;
 using namespace Rcpp;
@@ -12,11 +13,11 @@ using namespace Rcpp;
 //' @title runModel
 //' @description run whole model including model initializing, warm-up period, water balance and routing and returns list with states and fluxes 
 //' @param SimPeriod Period to simulate (usually defines as model[["SimPeriod"]] where model is object returned from basin.prepareRun())
-//' @param ListConst list with all required information regarding basin and input (usually, object returned by basin.prepareRun())
+//' @param ListConst list with all required information regarding basin and input (usually, object returned by basin.prepareRun()); optional entry "nThreadsRouting" defines the number of threads used for routing (default 1) for routing levels (and water-use colours) of at least "minCellsParallel" cells (default 64), optional entry "useSIMD" = FALSE switches off the vectorized daily kernels (default TRUE), optional entry "routingBlocked" = TRUE routes subtrees of the network (about "maxSubtreeSize" cells, default 256) for blocks of days if water use is off (default FALSE = day by day)
 //' @param Settings vector of length 8 that is used to define settings:
 //'  \itemize{
 //'   \item 1st entry: water use               -> 0 (off), 1 (on), 2 (on, including water transport to cities)
-//'   \item 2nd entry: water use allocation    -> 0 (temporal & spatial distr.), 1 (spatial distr.), 2 (temporal distr.)
+//'   \item 2nd entry: water use allocation    -> 0 (temporal & spatial distr.), 1 (spatial distr.), 2 (temporal distr.), 3 (temporal & spatial distr. along the river network)
 //'   \item 3rd entry: flow velocity           -> 0 (constant), 1 (variable)
 //'   \item 4th entry: gap year                -> 0 (including 29.02), 1 (without 29.02)
 //'   \item 5th entry: reservoir algorithm     -> 0 (Hanasaki), 1 (global lake)
@@ -24,37 +25,119 @@ using namespace Rcpp;
 //'   \item 7th entry: long wave radiation     -> 0 (reading), 1 (calculating)
 //'   \item 8th entry: warm up period          -> 0 (no system values), 1 (system values are read), 2 (system values are written), 3 (system values are read and written) }
 //' @param nYears number of years defined as warm-up (first year is then simulated n times, before starting with the actual simulation)
+//' @param outputVars names of the output variables to keep as path in the output list without "daily"/"routing", e.g. c("River$Discharge", "Storages$SoilContent", "Res$Storage");
+//' other output is not allocated and returned as empty matrix (NULL = all variables); if defined, water balance and routing are simulated day by day (see runModelCoupled())
+//' @param outputTimestep "daily", "monthly", "yearly" or "longterm": mean values of every month, year or of the whole simulation period are calculated during the simulation
+//' and returned as rows of the output matrices instead of daily values (water balance and routing are then simulated day by day as well)
 //' @export
 // [[Rcpp::export]]
-List runModel(DateVector SimPeriod, List ListConst, NumericVector Settings, int nYears){
+List runModel(DateVector SimPeriod, List ListConst, NumericVector Settings, int nYears, Nullable<CharacterVector> outputVars = R_NilValue,
+			std::string outputTimestep = "daily"){
 
-	defSettings(Settings); //defines Settings
-	initModel(ListConst); // defines Variables and Input data
-	initializeModel(); // initializes Vectors that defines fluxes and states in Model
+	ModelContext ctx; // the model only exists during this call
+	defSettings(ctx, Settings); //defines Settings
+	initModel(ctx, ListConst); // defines Variables and Input data
 	
-	if ((useSystemVals == 1) || (useSystemVals == 3)){
-		setStorages(SimPeriod); //initial values will be read into the system
+	return(runModel(ctx, SimPeriod, nYears, getOutputSpec(outputVars, outputTimestep)));
+}
+
+//' @title runModelContext
+//' @description runs a model that was created with initModelContext() (model initializing, warm-up period, water balance and routing) and returns list with states and fluxes;
+//' several models can exist next to each other in one R session
+//' @param modelContext model created with initModelContext()
+//' @param SimPeriod Period to simulate (usually defines as model[["SimPeriod"]] where model is object returned from basin.prepareRun())
+//' @param nYears number of years defined as warm-up (first year is then simulated n times, before starting with the actual simulation)
+//' @export
+// [[Rcpp::export]]
+List runModelContext(SEXP modelContext, DateVector SimPeriod, int nYears){
+	
+	ModelContext& ctx = getModelContext(modelContext);
+	ctx.par.init(ctx.ListConst); // resets parameters that are changed during a simulation (e.g. G_LAKAREA in CheckResType()), forcing and other input are kept
+	
+	return(runModel(ctx, SimPeriod, nYears));
+}
+
+// runs the model defined in ctx (settings and input data need to be defined already)
+List runModel(ModelContext& ctx, DateVector SimPeriod, int nYears, const OutputSpec& spec){
+	
+	WaterBalanceOutput dailyOutput;
+	RoutingOutput routingOutput;
+	
+	prepareModelRun(ctx, SimPeriod, nYears, dailyOutput, routingOutput, spec);
+	if (spec.all && (spec.timestep == 0)) {
+		simulateModelRun(ctx, nYears, dailyOutput, routingOutput);
+	} else {
+		simulateModelRunCoupled(ctx, nYears, dailyOutput, routingOutput); // daily run-off is not stored for the routing
+	}
+	
+	return(finishModelRun(ctx, SimPeriod, dailyOutput, routingOutput));
+}
+
+// initializes states, reads system values and allocates output (uses R API -> only in main thread)
+void prepareModelRun(ModelContext& ctx, DateVector SimPeriod, int nYears, WaterBalanceOutput& dailyOutput, RoutingOutput& routingOutput,
+			const OutputSpec& spec){
+
+	checkOutputSpec(spec, dailyOutput, routingOutput);
+	
+	initModelRun(ctx, SimPeriod, nYears);
+	
+	initWaterBalanceOutput(ctx, dailyOutput, spec);
+	initRoutingOutput(ctx, routingOutput, spec);
+}
+
+// stops if a requested output variable does not exist
+void checkOutputSpec(const OutputSpec& spec, WaterBalanceOutput& dailyOutput, RoutingOutput& routingOutput){
+	
+	set<string> names = {"River$Discharge", "River$StatVelocity"};
+	vector< pair<string, OutputMatrix*> > table = getWaterBalanceOutputTable(dailyOutput);
+	for (size_t i = 0; i < table.size(); i++){
+		names.insert(table[i].first);
+	}
+	table = getRoutingOutputTable(routingOutput);
+	for (size_t i = 0; i < table.size(); i++){
+		names.insert(table[i].first);
 	}
 	
-	if ( ((useSystemVals == 1) || (useSystemVals == 3)) & (nYears > 0)) {
+	for (set<string>::const_iterator it = spec.vars.begin(); it != spec.vars.end(); ++it){
+		if (names.count(*it) == 0){
+			stop("Output variable '%s' does not exist (e.g. 'River$Discharge', 'Storages$SoilContent' or 'Res$Storage')", it->c_str());
+		}
+	}
+}
+
+// initializes states and reads system values (uses R API -> only in main thread)
+void initModelRun(ModelContext& ctx, DateVector SimPeriod, int nYears){
+
+	initializeModel(ctx); // initializes Vectors that defines fluxes and states in Model
+	initSimPeriod(ctx, SimPeriod);
+	
+	if ((ctx.useSystemVals == 1) || (ctx.useSystemVals == 3)){
+		setStorages(ctx, SimPeriod); //initial values will be read into the system
+	}
+	
+	if ( ((ctx.useSystemVals == 1) || (ctx.useSystemVals == 3)) & (nYears > 0)) {
 		stop("'nyears' should be equal to 0 when using using SystemValues to define initial storages!");
 	}
+}
+
+// warm-up period, water balance and routing (does not use the R API, so it can run in a worker thread)
+void simulateModelRun(ModelContext& ctx, int nYears, WaterBalanceOutput& dailyOutput, RoutingOutput& routingOutput){
 	
-	runWarmUp(SimPeriod, nYears); // simulating the first year nTimes to define fluxes and states in Model
+	runWarmUp(ctx, nYears); // simulating the first year nTimes to define fluxes and states in Model
 	
-	List WaterBalanceOutput = createWaterBalance(SimPeriod); //calculates WaterBalance
+	simulateWaterBalance(ctx, dailyOutput); //calculates WaterBalance
 	
-	List Fluxes = as<List>(WaterBalanceOutput["Fluxes"]);
-		NumericMatrix surfaceRunoff = as<NumericMatrix>(Fluxes["dailyLocalSWRunoff"]);
-		NumericMatrix GroundwaterRunoff = as<NumericMatrix>(Fluxes["dailyLocalGWRunoff"]);
-		NumericMatrix PETw = as<NumericMatrix>(Fluxes["PETw"]);
-		
+	simulateRouting(ctx, routingOutput, dailyOutput.Flux_dailyLocalSWRunoff, dailyOutput.Flux_dailyLocalGWRunoff, 
+					dailyOutput.PETw, ctx.Prec); // is quite slow - mm/day - excecutes routing
+}
+
+// creates output list and writes system values (uses R API -> only in main thread)
+List finishModelRun(ModelContext& ctx, DateVector SimPeriod, WaterBalanceOutput& dailyOutput, RoutingOutput& routingOutput){
 	
-	List RoutingOutput = routing(SimPeriod, surfaceRunoff, GroundwaterRunoff, PETw, Prec); // is quite slow - mm/day - excecutes routing
-	List L = List::create(Named("daily") = WaterBalanceOutput, Named("routing") = RoutingOutput);
+	List L = List::create(Named("daily") = getWaterBalanceOutput(ctx, dailyOutput), Named("routing") = getRoutingOutput(ctx, routingOutput));
 	
-	if ((useSystemVals == 2) || (useSystemVals == 3)){
-		writeStorages(SimPeriod); //system values will be write out
+	if ((ctx.useSystemVals == 2) || (ctx.useSystemVals == 3)){
+		writeStorages(ctx, SimPeriod); //system values will be write out
 	}
 	
 	return(L);
@@ -0,0 +1,25 @@
+#ifndef RUNMODEL_H
+#define RUNMODEL_H
+
+#include <Rcpp.h>
+#include "ModelContext.h"
+#include "daily.h"
+#include "routing.h"
+
+using namespace std;
+using namespace Rcpp;
+
+List runModel(ModelContext& ctx, DateVector SimPeriod, int nYears, const OutputSpec& spec = OutputSpec());
+
+// a model run is split into parts with R API (prepare, finish) and the simulation itself, which runs without R (see runModelBatch())
+void prepareModelRun(ModelContext& ctx, DateVector SimPeriod, int nYears, WaterBalanceOutput& dailyOutput, RoutingOutput& routingOutput,
+			const OutputSpec& spec = OutputSpec());
+void simulateModelRun(ModelContext& ctx, int nYears, WaterBalanceOutput& dailyOutput, RoutingOutput& routingOutput);
+List finishModelRun(ModelContext& ctx, DateVector SimPeriod, WaterBalanceOutput& dailyOutput, RoutingOutput& routingOutput);
+void initModelRun(ModelContext& ctx, DateVector SimPeriod, int nYears);
+void checkOutputSpec(const OutputSpec& spec, WaterBalanceOutput& dailyOutput, RoutingOutput& routingOutput);
+
+// water balance and routing day by day (see runModelCoupled())
+void simulateModelRunCoupled(ModelContext& ctx, int nYears, WaterBalanceOutput& dailyOutput, RoutingOutput& routingOutput);
+
+#endif
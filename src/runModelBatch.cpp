@@ -0,0 +1,177 @@
+#include <Rcpp.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "initModel.h"
+#include "runModel.h"
+
+using namespace std;
+using namespace Rcpp;
+
+// one basin of runModelBatch()
+struct BatchRun {
+	ModelContext ctx;
+	DateVector SimPeriod;
+	WaterBalanceOutput dailyOutput;
+	RoutingOutput routingOutput;
+	string error; // exceptions can not be passed to R from a worker thread
+};
+
+// basins are passed from the main thread (preparation and output, R API) to the worker threads (simulation) and back
+struct BatchPool {
+	mutex m;
+	condition_variable workReady; // basin in todo or shutdown
+	condition_variable runDone; // basin in done
+	deque<int> todo; // prepared basins, largest first
+	deque<int> done; // simulated basins
+	bool shutdown = false;
+};
+
+// worker thread: simulates basins until the pool is shut down (no R API in here!)
+void batchWorker(vector< unique_ptr<BatchRun> >& runs, BatchPool& pool, int nYears){
+	while (true){
+		int run;
+		{
+			unique_lock<mutex> lock(pool.m);
+			pool.workReady.wait(lock, [&pool]() { return(pool.shutdown || !pool.todo.empty()); });
+			if (pool.shutdown) {
+				return;
+			}
+			run = pool.todo.front();
+			pool.todo.pop_front();
+		}
+
+		BatchRun& r = *runs[run]; // is not touched by the main thread until it is in done
+		try {
+			simulateModelRun(r.ctx, nYears, r.dailyOutput, r.routingOutput);
+		} catch (std::exception& e) {
+			r.error = e.what();
+		} catch (...) {
+			r.error = "unknown error";
+		}
+
+		{
+			lock_guard<mutex> lock(pool.m);
+			pool.done.push_back(run);
+		}
+		pool.runDone.notify_one();
+	}
+}
+
+// basins that are not started yet are dropped, running basins are finished
+void stopBatchPool(BatchPool& pool, vector<thread>& threads){
+	{
+		lock_guard<mutex> lock(pool.m);
+		pool.shutdown = true;
+		pool.todo.clear();
+	}
+	pool.workReady.notify_all();
+	for (size_t t = 0; t < threads.size(); t++){
+		threads[t].join();
+	}
+	threads.clear();
+}
+
+//' @title runModelBatch
+//' @description runs several models (e.g. different basins) in parallel threads and returns a list with the output of runModel() for each basin;
+//' basins are prepared in the main thread when a thread is free and handed to a pool of threads, largest basin (array_size x days) first,
+//' so only about nThreads basins (input, states and daily output) are in memory at once - results are the same as with runModel(), independent of the number of threads;
+//' if more than one thread is used, "nThreadsRouting" of the basins is ignored (routing of every basin runs in its pool thread)
+//' @param ListConstList list of model inputs (objects returned by basin.prepareRun()), the simulation period is taken from entry "SimPeriod"
+//' @param Settings vector of length 8 that is used to define settings (see runModel()), same for all basins
+//' @param nYears number of years defined as warm-up (see runModel()), same for all basins
+//' @param nThreads number of threads (0 = number of available cores)
+//' @return list with output of runModel() for each entry of ListConstList
+//' @export
+// [[Rcpp::export]]
+List runModelBatch(List ListConstList, NumericVector Settings, int nYears, int nThreads){
+
+	const int nRuns = ListConstList.length();
+
+	if (nThreads <= 0) {
+		nThreads = max((int) thread::hardware_concurrency(), 1);
+	}
+	nThreads = max(min(nThreads, nRuns), 1);
+
+	// largest basins first (array_size x days)
+	vector<double> size(nRuns);
+	for (int i = 0; i < nRuns; i++){
+		List ListConst = as<List>(ListConstList[i]);
+		size[i] = as<double>(ListConst["array_size"]) * as<DateVector>(ListConst["SimPeriod"]).length();
+	}
+	vector<int> order(nRuns);
+	for (int i = 0; i < nRuns; i++){
+		order[i] = i;
+	}
+	stable_sort(order.begin(), order.end(), [&size](int a, int b) { return(size[a] > size[b]); });
+
+	vector< unique_ptr<BatchRun> > runs(nRuns);
+	BatchPool pool;
+	vector<thread> threads;
+	for (int t = 0; t < nThreads; t++){
+		threads.push_back(thread(batchWorker, ref(runs), ref(pool), nYears));
+	}
+
+	List Output(nRuns);
+	try {
+		int next = 0; // next basin to prepare
+		int active = 0; // prepared basins that are not finished yet
+		while ((next < nRuns) || (active > 0)){
+
+			// everything that needs the R API is done in the main thread: preparing a basin if a thread is free ...
+			if ((next < nRuns) && (active < nThreads)) {
+				const int i = order[next++];
+				runs[i].reset(new BatchRun());
+				BatchRun& run = *runs[i];
+				List ListConst = as<List>(ListConstList[i]);
+				run.SimPeriod = as<DateVector>(ListConst["SimPeriod"]);
+
+				defSettings(run.ctx, Settings);
+				initModel(run.ctx, ListConst);
+				prepareModelRun(run.ctx, run.SimPeriod, nYears, run.dailyOutput, run.routingOutput);
+				run.ctx.checkInterrupt = false;
+				if (nThreads > 1) {
+					run.ctx.nThreadsRouting = 1; // basins are already simulated in parallel, no OpenMP team per basin (would oversubscribe the cores)
+				}
+
+				{
+					lock_guard<mutex> lock(pool.m);
+					pool.todo.push_back(i);
+				}
+				pool.workReady.notify_one();
+				active++;
+				continue;
+			}
+
+			// ... otherwise waiting for a basin to create its output, then the basin is freed
+			int i;
+			{
+				unique_lock<mutex> lock(pool.m);
+				pool.runDone.wait(lock, [&pool]() { return(!pool.done.empty()); });
+				i = pool.done.front();
+				pool.done.pop_front();
+			}
+			active--;
+
+			if (runs[i]->error.size() > 0){
+				stop("Error in basin %i: %s", i+1, runs[i]->error.c_str());
+			}
+			Output[i] = finishModelRun(runs[i]->ctx, runs[i]->SimPeriod, runs[i]->dailyOutput, runs[i]->routingOutput);
+			runs[i].reset();
+		}
+	} catch (...) {
+		stopBatchPool(pool, threads); // threads have to be finished before runs is destroyed
+		throw;
+	}
+	stopBatchPool(pool, threads);
+
+	if (ListConstList.hasAttribute("names")){
+		Output.names() = ListConstList.names();
+	}
+
+	return(Output);
+}
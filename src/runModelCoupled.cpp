@@ -0,0 +1,119 @@
+#include <Rcpp.h>
+#include "initModel.h"
+#include "initializeModel.h"
+#include "initialStorages.h"
+#include "daily.h"
+#include "routing.h"
+#include "runWarmUp.h"
+#include "runModel.h"
+#include "WaterUsePrepareRoutine.h"
+#include "WaterUseConsumSW.h"
+#include "routingRiver.h"
+
+using namespace std;
+using namespace Rcpp;
+
+//' @title runModelCoupled
+//' @description same as runModel(), but water balance and routing are simulated day by day (like in the warm-up period),
+//' so run-off and PET are passed to the routing without storing them for the whole simulation period;
+//' only the output variables in outputVars are returned as daily output (all other matrices in the output list are empty),
+//' states at the end of the simulation period are returned and written as system values like in runModel()
+//' @param SimPeriod Period to simulate (see runModel())
+//' @param ListConst list with all required information regarding basin and input (see runModel())
+//' @param Settings vector of length 8 that is used to define settings (see runModel())
+//' @param nYears number of years defined as warm-up (see runModel())
+//' @param outputVars names of the output variables to keep (see runModel()), NULL = discharge and velocity at the outlet
+//' @param outputTimestep "daily", "monthly", "yearly" or "longterm" (see runModel())
+//' @export
+// [[Rcpp::export]]
+List runModelCoupled(DateVector SimPeriod, List ListConst, NumericVector Settings, int nYears, Nullable<CharacterVector> outputVars = R_NilValue,
+			std::string outputTimestep = "daily"){
+
+	ModelContext ctx; // the model only exists during this call
+	defSettings(ctx, Settings); //defines Settings
+	initModel(ctx, ListConst); // defines Variables and Input data
+
+	OutputSpec spec = getOutputSpec(outputVars, outputTimestep);
+	if (spec.all) {
+		spec.all = false;
+		spec.vars = {"River$Discharge", "River$StatVelocity"};
+	}
+
+	WaterBalanceOutput dailyOutput;
+	RoutingOutput routingOutput;
+	prepareModelRun(ctx, SimPeriod, nYears, dailyOutput, routingOutput, spec);
+
+	simulateModelRunCoupled(ctx, nYears, dailyOutput, routingOutput);
+
+	return(finishModelRun(ctx, SimPeriod, dailyOutput, routingOutput));
+}
+
+// warm-up period, then water balance and routing of every day before the next day is simulated - does not use the R API
+// results are the same as with simulateModelRun(): the water balance does not use the states of the routing and
+// CheckResType() only changes input of the routing
+// only output matrices that are allocated are written (see saveDay())
+void simulateModelRunCoupled(ModelContext& ctx, int nYears, WaterBalanceOutput& dailyOutput, RoutingOutput& routingOutput){
+
+	runWarmUp(ctx, nYears); // simulating the first year nTimes to define fluxes and states in Model
+
+	const int ndays = ctx.ndays;
+	const double landSize = getLandSize(ctx);
+
+	CheckResType(ctx);
+	initDownstreamPaths(ctx); // downstream cells of reservoirs (after CheckResType())
+	WaterUseInitMeanDemand(ctx); // mean demand of reservoirs
+	vector<double> K_release = initReleaseFactor(ctx); //release factor for reservoirs
+
+#ifdef _OPENMP
+	const int nThreads = ctx.routeStepsIndependent ? ctx.nThreadsRouting : 1; // see simulateRouting()
+#endif
+
+	for (int day = 0; day < ndays; day++){
+
+		if ((day % 100 == 0) && ctx.checkInterrupt) {
+			Rcpp::checkUserInterrupt(); // check for interrupt every 100 iterations
+		}
+
+		if (ctx.GapYearType == 1) { //avoid somulation of the 29.02 to compare modelling result to WG3
+			if ((ctx.SimDay[day] == 29) && (ctx.SimMonth[day] == 2)){
+				continue;
+			}
+		}
+
+		// DAILY ######################################################################
+
+		waterBalanceDay(ctx, day); // also calculates dailyUse of the day, which is used in the routing as well
+		saveWaterBalanceDay(ctx, dailyOutput, day);
+
+		// ROUTING ######################################################################
+
+		const vector<double>& MeanDemand = WaterUseMeanDemandDaily(ctx, ctx.SimYear[day]);
+
+		ctx.G_actualUse.fill(0); //clean up actual use from Surface Water Bodies
+		ctx.G_riverOutflow.fill(0); //to clean up routing network befor starting simulation of actual day
+
+		for (int n = 0; n < ctx.nRouteSteps; n++){ //routing steps from upstream to downstream (see initRoutingSchedule())
+#ifdef _OPENMP
+			#pragma omp parallel for schedule(static) num_threads(nThreads) if ((nThreads > 1) && (ctx.routeStepStart[n+1] - ctx.routeStepStart[n] >= ctx.minCellsParallel))
+#endif
+			for (int k = ctx.routeStepStart[n]; k < ctx.routeStepStart[n+1]; k++) {
+				const int cell = ctx.routeCells[k];
+				routingCell(ctx, routingOutput, day, cell, getUpstreamInflow(ctx, cell), ctx.Prec(day, cell), ctx.dailyPETw[cell],
+							ctx.G_dailyLocalGWRunoff[cell] + ctx.G_dailyLocalSurfaceRunoff[cell], MeanDemand, K_release, landSize);
+			}
+		}
+
+		//Abstracting Water Use for surface water
+		// river --> reservoir --> global lakes -->local lakes
+		if (ctx.SimDay[day] == 1 && ctx.SimMonth[day] == 1) {
+			ctx.G_totalUnsatisfiedUse.fill(0); //for every year the unsatisfied demand is set to 0
+		}
+
+		//subtract water use from cells for surface water bodies and note subtraction in vector
+		SubtractWaterConsumSW(ctx, ctx.WaterUseAllocationType, ctx.dailyUse, ctx.G_totalUnsatisfiedUse,
+						   ctx.S_river, ctx.S_ResStorage, ctx.S_gloLakeStorage,
+						   ctx.S_locLakeStorage,ctx.G_actualUse);
+
+		saveRoutingDay(ctx, routingOutput, day);
+	}
+}
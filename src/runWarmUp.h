@@ -1,6 +1,6 @@
 #ifndef RUNWARMUP_H
 #define RUNWARMUP_H
 
-void runWarmUp(DateVector timestring, int nYears);
+void runWarmUp(ModelContext& ctx, int nYears);
  
 #endif
\ No newline at end of file